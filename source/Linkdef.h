@@ -14,12 +14,19 @@
 #    pragma link C++ class tools::BaseError;
 #    pragma link C++ class tools::DataBase;
 #    pragma link C++ class tools::DataTable;
+#    pragma link C++ class tools::DataTable::View < double>;
+#    pragma link C++ class tools::DataTable::View < std::int64_t>;
+#    pragma link C++ class tools::TableRow;
 #    pragma link C++ class tools::DataBaseError;
 #    pragma link C++ class tools::DualStream;
 #    pragma link C++ class tools::DualStreamBuf;
 #    pragma link C++ class tools::ProgressBar;
 #    pragma link C++ class tools::Rand;
+#    pragma link C++ class tools::PhiloxRand;
 #    pragma link C++ class tools::Random;
+#    pragma link C++ class tools::BasicRandomStream < std::mt19937_64>;
+#    pragma link C++ class tools::BasicRandomStream < tools::Philox>;
+#    pragma link C++ class tools::Philox;
 #    pragma link C++ class tools::Regex;
 #    pragma link C++ class tools::Vector3Error;
 #    pragma link C++ class tools::Vector3 + ;
@@ -15,13 +15,25 @@
 #    define DATABASE__USE_ROOT 1
 #endif
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "BaseError.hh"
+#include "StringUtils.hh"
 #include "ToolsConfig.hh"
 
 #ifdef DATABASE__USE_ROOT
@@ -31,6 +43,13 @@ class TFile;
 namespace tools
 {
 class DataTable;
+class TableRow;
+namespace detail_database
+{
+class LineReader;
+struct Staging;
+class KeyArena;
+}  // namespace detail_database
 
 ////////////////////////////////////////////////////////////////
 ////////////////////////// exception ///////////////////////////
@@ -82,8 +101,9 @@ public:
    The string value extends to the end of the line if no '#' symbol is found.
    The space(s) between the last non-white character and the '#' symbol are ignored.
 
-  - To determine wether an entry has a numeric value or not, the first "word" after
-    the key is tested with std::stod method. Formats below should be valid:
+  - To determine wether an entry has a numeric value or not, the beginning of the
+    first "word" after the key is read as a number, whatever the locale, with a dot
+    or a comma as decimal separator. Formats below are valid:
       64320     6.4320     6,4320
       6.43e20   6.43E20    6,43e20
       6.43e-20  6.43E-20   6,43e-20 -6.43e+20
@@ -96,9 +116,47 @@ public:
   - New parameters may only be defined via ReadFile, not directly through operator[].
     It guards against typos in the argument to operator[] or user input.
 
-  - This class is a singleton: it can not be freely instantiated or deleted.
-    Use the GetDataBase members to get the unique instance of the class per program.
-    Creator and destructor are then private.
+  - Parameters read in a loop are best accessed through a Handle, obtained once with
+    GetHandle, or with a Key hashed at compile time, see the "_key" literal.
+
+  - Files are parsed by a hand-written single-pass tokenizer by default. The former
+    std::regex based parser is still available through SetParser(kRegex), to compare
+    both engines: they are expected to yield exactly the same content.
+    Files are memory mapped and parsed in place, unless SetLoading(kStream) is used
+    or the file can not be mapped (pipe, empty file...).
+
+  - Several files can be read concurrently with ReadFiles, with exactly the same
+    result as reading them one after the other with ReadFile.
+
+  - WriteBinary writes the database in a binary image, checksummed, which ReadBinary
+    reads back without parsing any text. With SetCache, ReadFile keeps such an image
+    of each file next to it, and reads it instead of the file while it is newer.
+
+  - A table too large to be held in memory is read row by row with StreamTable,
+    straight from its file, without being stored in the database.
+
+  - The GetDataBase members give the default instance of the program, shared by all
+    its parts: Publish, GetSnapshot and Reload apply to it only. Other instances can
+    be created and moved freely, for instance to hold several configurations at
+    once, and Clone gives a writable copy of any of them. The keys and the tables
+    are shared with the original, only the small entries of the parameters are
+    copied, so that the handles on the copy see its writes:
+    @code
+      DataBase variation = DataBase::GetDataBase().Clone();
+      variation.ReadFile("systematics.txt", nullptr, nullptr, DataBase::kOverride);
+    @endcode
+
+  - Once filled, the database can be frozen by Publish: the published database is
+    immutable, so any number of threads read it through GetDataBase without lock.
+    Without Publish, GetInputDataBase and GetDataBase share a single instance, only
+    switched between read/write and read-only, which is not safe to read concurrently.
+
+  - The published database is a version, which Reload replaces by a new one, read
+    again from the files, when asked or when a file was modified. The readers holding
+    a snapshot of a version keep a consistent view of it until they release it. A
+    version returned by GetDataBase is never deleted, since references and handles
+    on it may be kept: a program reloading often reads the versions through
+    GetSnapshot, so that they are deleted once released.
 
    Based on DCparam from DoubleChooz software, based on GLG4 package from Glenn
   Horton-Smith. Rewritten with std::string and regex by Jonathan Gaffiot.
@@ -106,46 +164,48 @@ public:
 
 class DataBase {
 public:
-    /// Singleton management
+    /// Constructors: an empty writable database, independent of the default instance
+    DataBase(): IsReadOnly(false) {}
+    DataBase(DataBase&&) = default;  // the handles on it stay valid
+    DataBase& operator=(DataBase&&) = default;
+    DataBase(const DataBase&) = delete;  // see Clone
+    DataBase& operator=(const DataBase&) = delete;
+    inline DataBase Clone() const { return DataBase(*this, false); }
+
+    /// Default instance management
     // Get reference to the read/write database, constructing as necessary. Use this
-    // only to fill the database.
-    static DataBase& GetInputDataBase() {
-        if (theDataBase == nullptr) {
-            theDataBase = new DataBase(false);
-        } else {
-            theDataBase->IsReadOnly = false;
-        }
-        return *theDataBase;
-    }
+    // only to fill the database. Once a database is published, this is a new copy of
+    // the published one, only visible to the readers at the next Publish.
+    static DataBase& GetInputDataBase() { return *GetInputDataBasePtr(); }
     // Get the pointer to the read/write database, constructing as necessary. Use this
     // only to fill the database.
-    static DataBase* GetInputDataBasePtr() {
-        if (theDataBase == nullptr) {
-            theDataBase = new DataBase(false);
-        } else {
-            theDataBase->IsReadOnly = false;
-        }
-        return theDataBase;
-    }
+    static DataBase* GetInputDataBasePtr();
 
-    // Get reference to the read-only database, constructing as necessary
-    static const DataBase& GetDataBase() {
-        if (theDataBase == nullptr) {
-            theDataBase = new DataBase(true);
-        } else {
-            theDataBase->IsReadOnly = true;
-        }
-        return *theDataBase;
-    }
+    // Freeze the read/write database and publish it as the read-only database. It is
+    // then never modified: any number of threads can read it without lock.
+    static void Publish();
+
+    // Get reference to the read-only database, constructing as necessary. Once a
+    // version is returned through this reference, it is never deleted, so that the
+    // reference stays valid after a new Publish or Reload.
+    static const DataBase& GetDataBase() { return *GetDataBasePtr(); }
     // Get the pointer to the read-only database, constructing as necessary
-    static DataBase const* GetDataBasePtr() {
-        if (theDataBase == nullptr) {
-            theDataBase = new DataBase(true);
-        } else {
-            theDataBase->IsReadOnly = true;
-        }
-        return theDataBase;
-    }
+    static DataBase const* GetDataBasePtr();
+
+    // Get the published database, publishing the read/write database if nothing is
+    // published yet. The version is deleted when its last snapshot is released,
+    // unless it was also returned by GetDataBase.
+    static std::shared_ptr<const DataBase> GetSnapshot();
+
+    /// Reload the published database: read again all the files read by ReadFile and
+    /// ReadFiles, in the same order, in a new version published once complete
+    enum EReload {
+        kAlways,
+        kIfModified  // only if a file was modified since it was read
+    };
+    static bool Reload(EReload reload = kAlways, unsigned nb_threads = 0);
+    bool IsModified() const;  // test if a file was modified since it was read
+    inline std::uint64_t GetVersion() const { return Version; }  // 0 if unpublished
 
     /// Getters, constant methods -> no need to check for IsReadOnly
     std::string GetPath(const char* env_path) const;
@@ -157,63 +217,188 @@ public:
     void WriteText(std::ostream& os) const;
     inline void Print() const { WriteText(std::cout); }
 
+    void WriteBinary(const char* filename, const char* env_path = nullptr) const;
+    void WriteBinary(std::ostream& os) const;
+
 #ifdef DATABASE__USE_ROOT
     void WriteRoot(const char* filename) const;
     void WriteRoot(TFile* file) const;
 #endif
 
-    double GetNumValue(const std::string& key) const;
-    const std::string& GetStrValue(const std::string& key) const;
+    // accessors taking a std::string_view, so that a lookup never allocates
+    double GetNumValue(std::string_view key) const;
+    const std::string& GetStrValue(std::string_view key) const;
 
     // bunch of classic accessors
-    inline double operator[](const std::string& key) const {
-        return GetNumValue(key);
-    }
-    inline const std::string& operator()(const std::string& key) const {
+    inline double operator[](std::string_view key) const { return GetNumValue(key); }
+    inline const std::string& operator()(std::string_view key) const {
         return GetStrValue(key);
     }
 
-    const std::shared_ptr<DataTable> GetTablePtr(const char* name) const;
-    inline const std::shared_ptr<DataTable> GetTablePtr(const std::string& name) const {
-        return GetTablePtr(name.c_str());
-    }
-    inline const DataTable& GetTable(const char* name) const {
+    const std::shared_ptr<DataTable> GetTablePtr(std::string_view name) const;
+    inline const DataTable& GetTable(std::string_view name) const {
         return *GetTablePtr(name);
     }
-    inline const DataTable& GetTable(const std::string& name) const {
-        return *GetTablePtr(name.c_str());
+
+    /** Key with its hash pre-computed, at compile time if declared constexpr:
+        @code
+          constexpr auto kPi = "pi"_key;  // or DataBase::Key("pi")
+          double pi = DataBase::GetDataBase()[kPi];
+        @endcode */
+    struct Key {
+        explicit constexpr Key(std::string_view name):
+            Name(name), Hash(strhash(name)) {}
+        std::string_view Name;
+        hash_t Hash;
+    };
+    double GetNumValue(const Key& key) const;
+    const std::string& GetStrValue(const Key& key) const;
+    inline double operator[](const Key& key) const { return GetNumValue(key); }
+    inline const std::string& operator()(const Key& key) const {
+        return GetStrValue(key);
     }
 
-    /** Test if key is in the numeric parameter table */
-    inline bool HasNumValue(const std::string& key) const {
-        return (NumMap.count(key) > 0);
+    /** Handle on a parameter: the key is looked up once, then each access costs a
+        pointer load, without any hashing or allocation. The handle follows the
+        changes of the values. */
+    class Handle;
+    Handle GetHandle(const Key& key) const;
+    inline Handle GetHandle(std::string_view key) const;
+
+    /** Handles on all the parameters under a prefix, i.e. whose key begins with the
+        prefix and a dot, in the alphabetical order of the keys, found in one pass
+        through an index of the sorted keys, all of them for an empty prefix. The
+        tables are not included. */
+    std::vector<Handle> GetHandlesWithPrefix(std::string_view prefix) const;
+
+    /** Copy the numeric values of "prefix.key" for the given keys into values, in
+        order, all the keys being checked first: throw, listing all the keys without
+        numeric value, before anything is copied. No dot is added to an empty prefix.
+        @code
+          double gain[3];
+          db.GetNumValues("pmt", {"gain0", "gain1", "gain2"}, gain);
+        @endcode */
+    void GetNumValues(
+        std::string_view prefix,
+        const std::vector<std::string_view>& keys,
+        double* values) const;
+
+    /** Test if key has a numeric value */
+    inline bool HasNumValue(std::string_view key) const {
+        const Entry* entry = Find(key);
+        return entry and entry->HasNum;
     }
-    /** Test if key is in the string parameter table */
-    inline bool HasStrValue(const std::string& key) const {
-        return (StringMap.count(key) > 0 && StringMap.at(key).size() > 0);
+    /** Test if key has a non empty string value */
+    inline bool HasStrValue(std::string_view key) const {
+        const Entry* entry = Find(key);
+        return entry and entry->HasStr and not entry->Str.empty();
     }
-    /** Test if key is in the table table */
-    inline bool HasTable(const std::string& tablename) const {
-        return (TableMap.count(tablename) > 0);
+    /** Test if key is a table */
+    inline bool HasTable(std::string_view tablename) const {
+        const Entry* entry = Find(tablename);
+        return entry and entry->Table;
     }
 
-    /** Get list of keys, in the order in which they were read in. */
-    inline const std::vector<std::string>& GetListOfKeys() const {
+    /** Get list of keys, in the order in which they were read in. The keys are
+        views valid as long as the database. */
+    inline const std::vector<std::string_view>& GetListOfKeys() const {
         return KeyList;
     }
 
     /// Setters, NON constant methods -> DO need to check for IsReadOnly
+    /// Redefinition of a key by a reading: by default the last value is taken
     enum EOverwrite {
-        kKeep,
-        kOverride
+        kKeep,  // the previous value is kept
+        kOverride  // the new value replaces the previous one
+    };
+    /// Engine used to parse the files: the tokenizer is much faster than the regex
+    enum EParser {
+        kTokenizer,
+        kRegex
+    };
+    inline void SetParser(EParser parser) { Parser = parser; }
+    inline EParser GetParser() const { return Parser; }
+    /// Access to the files: parse directly the memory mapped file, or through a stream
+    enum ELoading {
+        kMemoryMap,
+        kStream
+    };
+    inline void SetLoading(ELoading loading) { Loading = loading; }
+    inline ELoading GetLoading() const { return Loading; }
+    /// Size in bytes of the chunks of the body of a large table, parsed concurrently
+    inline void SetChunkSize(std::size_t size) {
+        ChunkSize = std::max<std::size_t>(size, 1);
+    }
+    inline std::size_t GetChunkSize() const { return ChunkSize; }
+    /// Binary image of the files read by ReadFile, named as the file plus ".bin"
+    enum ECache {
+        kNoCache,
+        kUseCache,  // read the image instead of the file if it is newer
+        kUpdateCache  // also write the image if it is missing or outdated
+    };
+    inline void SetCache(ECache cache) { Cache = cache; }
+    inline ECache GetCache() const { return Cache; }
+    /// Warnings of the last reading by ReadFile, ReadBinary or ReadFiles: counted by
+    /// kind, with the first lines or keys concerned, and printed as asked
+    enum EWarning {
+        kBadLine,  // line of bad format, skipped
+        kOverridden,  // key defined again, the new value replacing the previous one
+        kPreserved,  // key defined again, the previous value being kept
+        kCache,  // binary image of a file ignored or not written, see SetCache
+        kNbWarnings
+    };
+    enum EVerbosity {
+        kQuiet,  // nothing printed, see GetDiagnostics
+        kSummary,  // a few lines per kind of warning at the end of the reading
+        kVerbose  // each warning as it occurs
+    };
+    struct Diagnostics {
+        static constexpr std::size_t kNbExamples = 10;
+        std::array<std::size_t, kNbWarnings> Count{};
+        std::array<std::vector<std::string>, kNbWarnings> Examples;  // the first ones
     };
+    inline void SetVerbosity(EVerbosity verbosity) { Verbosity = verbosity; }
+    inline EVerbosity GetVerbosity() const { return Verbosity; }
+    inline const Diagnostics& GetDiagnostics() const { return Diags; }
+
     void ReadFile(
         const char* filename,
         const char* env_path = nullptr,
         const char* prefix = nullptr,
-        EOverwrite overwrite = kKeep);
+        EOverwrite overwrite = kOverride);
     void ReadFile(
-        std::istream& is, std::string prefix = "", EOverwrite overwrite = kKeep);
+        std::istream& is, std::string prefix = "", EOverwrite overwrite = kOverride);
+    void ReadBinary(
+        const char* filename,
+        const char* env_path = nullptr,
+        const char* prefix = nullptr,
+        EOverwrite overwrite = kOverride);
+
+    /// A file to read, as the arguments of ReadFile, empty strings meaning none
+    struct InputFile {
+        std::string filename;
+        std::string env_path;
+        std::string prefix;
+    };
+    void ReadFiles(
+        const std::vector<InputFile>& files,
+        EOverwrite overwrite = kOverride,
+        unsigned nb_threads = 0);
+
+    /** Call back on each row of a table of a file, in order, without storing the
+        table nor reading the rest of the file: the memory used does not depend on
+        the size of the table. The row is only valid during the call.
+        @code
+          double sum = 0;
+          db.StreamTable("hits.txt", "hits", [&sum](const TableRow& row) {
+              sum += row.GetNum(2);
+          });
+        @endcode */
+    void StreamTable(
+        const char* filename,
+        std::string_view tablename,
+        const std::function<void(const TableRow&)>& callback,
+        const char* env_path = nullptr) const;
 
     double& operator[](const std::string& key);
     std::string& operator()(const std::string& key);
@@ -230,22 +415,151 @@ private:
     explicit DataBase(bool isreadonly) {
         IsReadOnly = isreadonly;
     }
-    DataBase() = delete;
-    DataBase(const DataBase&) = delete;
-    DataBase(DataBase&&) = delete;
-    DataBase& operator=(const DataBase&) = delete;
-    DataBase& operator=(DataBase&&) = delete;
+    DataBase(const DataBase& base, bool isreadonly);  // copy sharing keys and tables
+
+    /// Reading in two steps: parsing in a staging area, then storing in the maps
+    void ParseFile(
+        const std::string& FileWithPath,
+        const std::string& prefix,
+        detail_database::Staging& staging) const;
+    void ParseText(
+        const std::string& FileWithPath,
+        const std::string& prefix,
+        detail_database::Staging& staging) const;
+    void ParseImage(
+        std::string_view image,
+        const std::string& prefix,
+        detail_database::Staging& staging) const;
+    void ParseLines(
+        detail_database::LineReader& reader,
+        std::string prefix,
+        detail_database::Staging& staging) const;
+    void Store(detail_database::Staging& staging, EOverwrite overwrite);
+    void Warn(EWarning warning, std::string_view example);  // count, keep, print
+    void FormatParameters(std::string& buffer) const;  // append them as in WriteText
+    void Report() const;  // print the summary of the warnings, if asked
+
+    /// A file read by ReadFile or ReadFiles, to read it again in Reload
+    struct Source {
+        std::string FileWithPath;
+        std::string Prefix;
+        EOverwrite Overwrite;
+        std::int64_t ModTime;  // last modification when read, in ns, -1 if unknown
+    };
+    static void PublishLocked(DataBase* database);  // to call with theMutex locked
+
+    /// Storage: all the values of a key together, indexed by a flat open-addressing
+    /// hash table with linear probing, to find a key in a single probe sequence.
+    /// The keys are interned in an arena, shared by the entries and KeyList.
+    struct Entry {
+        std::string_view Key;
+        hash_t Hash;
+        bool HasNum = false;
+        bool HasStr = false;
+        double Num = 0.;
+        std::string Str;
+        std::shared_ptr<DataTable> Table;
+    };
+    struct Slot {
+        std::uint32_t Hash;  // high bits of the hash of the key
+        std::uint32_t Index;  // position in Entries plus one, 0 for an empty slot
+    };
+    const Entry* Find(std::string_view key, hash_t hash) const;
+    inline const Entry* Find(std::string_view key) const {
+        return Find(key, strhash(key));
+    }
+    inline Entry* Find(std::string_view key, hash_t hash) {
+        return const_cast<Entry*>(std::as_const(*this).Find(key, hash));
+    }
+    inline Entry* Find(std::string_view key) { return Find(key, strhash(key)); }
+    std::string_view Intern(std::string_view key);  // a copy of the key in the arena
+    Entry& Insert(std::string_view key, hash_t hash);  // interned, must not exist yet
+    void Rehash(std::size_t nb_slots);
+    std::vector<const Entry*> GetSortedTables() const;
+
+    /// Entries sorted by key, for the prefix queries: built when first needed, and
+    /// built again when entries were inserted since. Moved with the entries, leaving
+    /// an empty one behind, so that a moved-from database can still be queried.
+    struct SortedKeys {
+        SortedKeys() = default;
+        SortedKeys(SortedKeys&& other) noexcept: Entries(std::move(other.Entries)) {
+            other.Entries.clear();
+        }
+        SortedKeys& operator=(SortedKeys&& other) noexcept {
+            Entries = std::move(other.Entries);
+            other.Entries.clear();
+            return *this;
+        }
+        std::mutex Mutex;  // a new one for each database, never moved
+        std::vector<const Entry*> Entries;
+    };
 
     /// Members
     bool IsReadOnly;  // read-only most of time, when reading values from map
-    static DataBase* theDataBase;  // common instance for database
+    EParser Parser = kTokenizer;  // engine used by ReadFile
+    ELoading Loading = kMemoryMap;  // access to the files read by ReadFile
+    std::size_t ChunkSize = 1 << 20;  // of the bodies of the tables parsed concurrently
+    ECache Cache = kNoCache;  // use of the binary images of the files
+    EVerbosity Verbosity = kSummary;  // printing of the warnings of the readings
+    Diagnostics Diags;  // warnings of the last reading
+    std::uint64_t Version = 0;  // number of the publication
+    std::vector<Source> Sources;  // the files read, in order
+    static DataBase* theDataBase;  // common instance for database, being filled
+    static std::atomic<const DataBase*> thePublished;  // frozen instance, if any
+    static std::atomic<const DataBase*> theReferenced;  // last one of GetDataBase
+    static std::shared_ptr<const DataBase> theSnapshot;  // owner of thePublished
+    static std::vector<std::shared_ptr<const DataBase>> theRetired;  // referenced
+    static std::mutex theMutex;  // guards the static members but the atomic ones
+    static std::mutex theReloadMutex;  // only one reload at a time
+
+    std::shared_ptr<detail_database::KeyArena> Keys;  // owner of the keys
+    std::vector<std::string_view> KeyList;  // to preserve order
+    std::deque<Entry> Entries;  // never moved, references to values stay valid
+    std::vector<Slot> Slots;  // the hash index on Entries, size is a power of 2
+    mutable SortedKeys Sorted;  // built by the const prefix queries
+};
+
+class DataBase::Handle {
+public:
+    Handle() = default;  // invalid handle, use DataBase::GetHandle
+
+    inline bool IsValid() const { return theEntry != nullptr; }
+    inline std::string_view GetKey() const { return theEntry->Key; }
 
-    std::vector<std::string> KeyList;  // to preserve order
-    std::map<std::string, double> NumMap;  // numeric values
-    std::map<std::string, std::string> StringMap;  // string values
-    std::map<std::string, std::shared_ptr<DataTable>> TableMap;  // tables
+    inline double GetNumValue() const {
+        if (not theEntry->HasNum) {
+            throw DataBaseError(
+                " ***Error DataBase::Handle::GetNumValue: No numeric value for key ",
+                theEntry->Key);
+        }
+        return theEntry->Num;
+    }
+    inline const std::string& GetStrValue() const {
+        if (not theEntry->HasStr) {
+            throw DataBaseError(
+                " ***Error DataBase::Handle::GetStrValue: No string value for key ",
+                theEntry->Key);
+        }
+        return theEntry->Str;
+    }
+    inline double operator*() const { return GetNumValue(); }
+
+private:
+    friend class DataBase;
+    explicit Handle(const Entry* entry): theEntry(entry) {}
+
+    const Entry* theEntry = nullptr;
 };
 
+inline DataBase::Handle DataBase::GetHandle(std::string_view key) const {
+    return GetHandle(Key(key));
+}
+
+//! operator _key intended for a constexpr DataBase key from a C-string
+constexpr DataBase::Key operator"" _key(const char* const p, size_t n) {
+    return DataBase::Key(std::string_view(p, n));
+}
+
 ////////////////////////////////////////////////////////////////
 ///////////////////////// DataTable ///////////////////////////
 ////////////////////////////////////////////////////////////////
@@ -294,6 +608,36 @@ private:
      for (int ipmt=0; ipmt<pmt.NRows(); ipmt++)
        make_PMT( id[ipmt].Atoi(), shape[ipmt] );
     @endcode
+
+    The type of each column is inferred when the table is read: a column of numbers
+    is also stored as a contiguous array of double, and of std::int64_t if they are
+    all integers, read without any conversion nor copy through a View:
+    @code
+     DataTable::View<double> x( pmt.GetNumColumn("x") );
+     for (double xi : x)
+       ...
+    @endcode
+
+    All the columns of a row are read together by binding them to the members of a
+    struct, checked against the names and the types of the columns, in a contiguous
+    array, or by iterating over the rows as tuples of references on the columns:
+    @code
+     struct PMT { int id; double x, y, z; };
+     std::vector<PMT> pmts( pmt.GetRows<PMT>(DataTable::Bind("id", &PMT::id),
+       DataTable::Bind("x", &PMT::x), DataTable::Bind("y", &PMT::y),
+       DataTable::Bind("z", &PMT::z)) );
+     for (auto [id, x] : pmt.Rows<std::int64_t, double>("id", "x"))
+       ...
+    @endcode
+
+    A row is found by its value in a column through an index, a hash table for the
+    exact values or the rows sorted by value for the ranges, built at the first lookup
+    or beforehand by BuildIndex, safely from any number of threads:
+    @code
+     int row = pmt.FindRow("id", 42);  // -1 if none
+     for (int row : pmt.RowsInRange("x", -0.5, 0.5))
+       ...
+    @endcode
 */
 class DataTable {
 public:
@@ -302,46 +646,287 @@ public:
     inline int GetNbColumns() const { return ColNames.size(); }
     inline const std::vector<std::string>& GetColumnNames() const { return ColNames; }
 
-    std::vector<double> GetColumnAsNum(const std::string& colname) const;
-    inline const Col_t& GetColumn(const std::string& colname) const {
-        if (ColMap.count(colname) == 0) {
-            throw DataBaseError(
-                " ***Error DataTable::operator[]: Unknown column ", colname);
+    /// Type of a column, inferred from all its cells
+    enum EType {
+        kInt,  // integers, also available as double
+        kDouble,
+        kString
+    };
+    /// Read-only view on a typed column, as a std::span of C++20
+    template<typename T>
+    class View {
+    public:
+        View(const T* data, std::size_t size): Data(data), Size(size) {}
+        inline const T* data() const { return Data; }
+        inline std::size_t size() const { return Size; }
+        inline bool empty() const { return Size == 0; }
+        inline const T* begin() const { return Data; }
+        inline const T* end() const { return Data + Size; }
+        inline const T& operator[](std::size_t i) const { return Data[i]; }
+
+    private:
+        const T* Data;
+        std::size_t Size;
+    };
+
+    inline EType GetColumnType(std::string_view colname) const {
+        return FindColumn(colname, "GetColumnType").Type;
+    }
+    View<double> GetNumColumn(std::string_view colname) const;
+    View<std::int64_t> GetIntColumn(std::string_view colname) const;
+
+    /// A member of a struct S bound to a column, see GetRows
+    template<typename S, typename T>
+    struct Field {
+        std::string_view Name;
+        T S::*Member;
+    };
+    template<typename S, typename T>
+    static inline Field<S, T> Bind(std::string_view colname, T S::*member) {
+        return {colname, member};
+    }
+    /// Copy the rows in an array of S, with each bound member set from its column: an
+    /// integer member from a kInt column, a floating point one from a numeric column,
+    /// a std::string from any column
+    template<typename S, typename... Ts>
+    std::vector<S> GetRows(const Field<S, Ts>&... fields) const {
+        std::vector<S> rows(NbRow);
+        (SetMember(rows, fields), ...);
+        return rows;
+    }
+
+    /// Rows as tuples of references on the cells of the given columns, each type
+    /// being std::int64_t, double or std::string as for the Views
+    template<typename... Ts>
+    class RowRange {
+    public:
+        class Iterator {
+        public:
+            Iterator(const std::tuple<const Ts*...>* arrays, int row):
+                Arrays(arrays), Row(row) {}
+            inline std::tuple<const Ts&...> operator*() const {
+                return std::apply(
+                    [this](const Ts*... array) {
+                        return std::tuple<const Ts&...>(array[Row]...);
+                    },
+                    *Arrays);
+            }
+            inline Iterator& operator++() {
+                ++Row;
+                return *this;
+            }
+            inline bool operator!=(const Iterator& other) const {
+                return Row != other.Row;
+            }
+
+        private:
+            const std::tuple<const Ts*...>* Arrays;
+            int Row;
+        };
+
+        RowRange(std::tuple<const Ts*...> arrays, int nbrow):
+            Arrays(arrays), NbRow(nbrow) {}
+        inline Iterator begin() const { return {&Arrays, 0}; }
+        inline Iterator end() const { return {&Arrays, NbRow}; }
+        inline int size() const { return NbRow; }
+        inline std::tuple<const Ts&...> operator[](int row) const {
+            return *Iterator(&Arrays, row);
         }
-        return ColMap.at(colname);
+
+    private:
+        std::tuple<const Ts*...> Arrays;
+        int NbRow;
+    };
+    template<typename T>
+    using ColumnName = std::string_view;
+    template<typename... Ts>
+    inline RowRange<Ts...> Rows(ColumnName<Ts>... colnames) const {
+        return {{GetArray<Ts>(colnames, "Rows")...}, NbRow};
+    }
+
+    /// Index of a column
+    enum EIndex {
+        kHash,  // exact integers of a kInt column, or exact texts of any column
+        kSorted  // numbers of a numeric column
+    };
+    void BuildIndex(std::string_view colname, EIndex index) const;
+    // first row with the value, -1 if none
+    int FindRow(std::string_view colname, std::int64_t value) const;
+    int FindRow(std::string_view colname, std::string_view value) const;
+    // rows with lo <= value <= hi, in the order of the values
+    View<int> RowsInRange(std::string_view colname, double lo, double hi) const;
+
+    std::vector<double> GetColumnAsNum(std::string_view colname) const;
+    inline const Col_t& GetColumn(std::string_view colname) const {
+        return FindColumn(colname, "operator[]").Str;
     }
 
-    inline const Col_t& operator[](const std::string& colname) const {
+    inline const Col_t& operator[](std::string_view colname) const {
         return GetColumn(colname);
     }
-    inline double operator()(const std::string& colname, int iRow) const {
+    inline double operator()(std::string_view colname, int iRow) const {
         if (iRow < 0 or iRow >= NbRow) {
             throw DataBaseError(
                 " ***Error DataTable::operator(): No line number: ", iRow);
         }
-        return std::stod(GetColumn(colname).at(iRow));
+        const Column& column = FindColumn(colname, "operator()");
+        if (column.Type != kString) {
+            return column.Num[iRow];
+        }
+        return ToNum(column.Str[iRow], "operator()");
     }
 
     void Print(std::ostream& os) const;
     inline void Print() const { Print(std::cout); }
+    void Format(std::string& buffer) const;  // append the table as written by Print
 
 private:
+    /// The indexes of a column, each built once when first needed
+    struct Index {
+        std::once_flag IntOnce, TextOnce, SortedOnce;
+        std::vector<int> IntSlots;  // hash table of row+1 on Int, 0 for an empty slot
+        std::vector<int> TextSlots;  // hash table of row+1 on Str
+        std::vector<int> Sorted;  // rows sorted by Num, without the NaN
+    };
+
+    /// A column with all its representations
+    struct Column {
+        Col_t Str;  // the cells as read
+        std::vector<double> Num;  // filled unless the type is kString
+        std::vector<std::int64_t> Int;  // filled only if the type is kInt
+        EType Type = kString;
+        std::unique_ptr<Index> Indexes = std::make_unique<Index>();  // built if const
+    };
+
     // Constructor is private, so that only DataBase creates DataTable, thanks to the
     // friend declaration below
-    DataTable(std::istream& is, std::string& line);
+    DataTable(
+        detail_database::LineReader& reader,
+        std::string_view header,
+        DataBase::EParser parser,
+        std::size_t chunk_size);
+    DataTable(
+        std::vector<std::string> colnames, std::vector<Column> columns, int nbrow);
     DataTable() = delete;
     DataTable(const DataTable&) = delete;
     DataTable(DataTable&&) = delete;
     DataTable& operator=(const DataTable&) = delete;
     DataTable& operator=(DataTable&&) = delete;
 
-    friend void DataBase::ReadFile(std::istream&, std::string, EOverwrite);
+    friend class DataBase;
+
+    inline const Column& FindColumn(
+        std::string_view colname, const char* method) const {
+        auto it = ColMap.find(colname);
+        if (it == ColMap.end()) {
+            throw DataBaseError(
+                " ***Error DataTable::", method, ": Unknown column ", colname);
+        }
+        return it->second;
+    }
+    void SetTypes();  // infer the types once the columns are filled
+    static double ToNum(const std::string& cell, const char* method);
+    const std::vector<int>& GetIntSlots(const Column& column) const;
+    const std::vector<int>& GetTextSlots(const Column& column) const;
+    const std::vector<int>& GetSorted(const Column& column) const;
+
+    // the array of a column, with the type checked
+    template<typename T>
+    const T* GetArray(std::string_view colname, const char* method) const {
+        const Column& column = FindColumn(colname, method);
+        if constexpr (std::is_same_v<T, std::string>) {
+            return column.Str.data();
+        } else if constexpr (std::is_same_v<T, double>) {
+            if (column.Type == kString) {
+                throw DataBaseError(
+                    " ***Error DataTable::",
+                    method,
+                    ": Not a numeric column: ",
+                    colname);
+            }
+            return column.Num.data();
+        } else {
+            static_assert(
+                std::is_same_v<T, std::int64_t>,
+                "A column is read as std::int64_t, double or std::string");
+            if (column.Type != kInt) {
+                throw DataBaseError(
+                    " ***Error DataTable::",
+                    method,
+                    ": Not an integer column: ",
+                    colname);
+            }
+            return column.Int.data();
+        }
+    }
 
-    std::map<std::string, Col_t> ColMap;  // map of column vectors
+    template<typename S, typename T>
+    void SetMember(std::vector<S>& rows, const Field<S, T>& field) const {
+        if constexpr (std::is_same_v<T, std::string>) {
+            const std::string* cells = GetArray<std::string>(field.Name, "GetRows");
+            for (int i = 0; i < NbRow; i++) {
+                rows[i].*field.Member = cells[i];
+            }
+        } else if constexpr (std::is_floating_point_v<T>) {
+            const double* cells = GetArray<double>(field.Name, "GetRows");
+            for (int i = 0; i < NbRow; i++) {
+                rows[i].*field.Member = static_cast<T>(cells[i]);
+            }
+        } else {
+            static_assert(
+                std::is_integral_v<T>,
+                "A column is bound to an integer, a floating point or a std::string");
+            const std::int64_t* cells = GetArray<std::int64_t>(field.Name, "GetRows");
+            for (int i = 0; i < NbRow; i++) {
+                const T value = static_cast<T>(cells[i]);
+                if (static_cast<std::int64_t>(value) != cells[i]
+                    or (std::is_unsigned_v<T> and cells[i] < 0)) {
+                    throw DataBaseError(
+                        " ***Error DataTable::GetRows: Value out of range in column ",
+                        field.Name,
+                        " on row ",
+                        i);
+                }
+                rows[i].*field.Member = value;
+            }
+        }
+    }
+
+    // map of columns, std::less<> allows the lookup with a std::string_view
+    std::map<std::string, Column, std::less<>> ColMap;
     std::vector<std::string> ColNames;  // column names, in order
     int NbRow = 0;
 };
 
+////////////////////////////////////////////////////////////////
+////////////////////////// TableRow ////////////////////////////
+////////////////////////////////////////////////////////////////
+
+/** A row of a table read by DataBase::StreamTable: its cells are views on the line
+    being parsed, valid only during the callback. The cells are given as text, and
+    converted on request, with the same rules as the columns of a DataTable. */
+class TableRow {
+public:
+    /// Number of the row in the table, from 0
+    inline int GetRow() const { return Row; }
+    inline int GetNbColumns() const { return static_cast<int>(ColNames.size()); }
+    inline const std::vector<std::string>& GetColumnNames() const { return ColNames; }
+    /// Position of a column, to be looked up once before the rows
+    int GetColumn(std::string_view colname) const;
+
+    inline std::string_view operator[](int col) const { return Cells[col]; }
+    double GetNum(int col) const;
+    std::int64_t GetInt(int col) const;
+
+private:
+    friend class DataBase;
+    TableRow() = default;
+
+    std::vector<std::string> ColNames;
+    const std::string_view* Cells = nullptr;
+    int Row = 0;
+};
+
 }  // namespace tools
 
 #endif /* TOOLS_DATABASE_HH */
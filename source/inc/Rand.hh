@@ -9,9 +9,14 @@
 #ifndef TOOLS_RAND_HH
 #define TOOLS_RAND_HH 2
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
-#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <random>
 #include <type_traits>
 #include <utility>
@@ -19,12 +24,20 @@
 #include "Math.hh"
 #include "Vector3.hh"
 
+// SIMD versions of Philox, chosen at run time from the instructions of the CPU
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#    define RAND__X86_SIMD
+#    include <immintrin.h>
+#endif
+
 namespace tools
 {
-// a useful typedef
-template<class vector = Vector3>
+// useful typedefs
+class Philox;
+template<class vector = Vector3, class engine = std::mt19937_64>
 class Random;
 using Rand = Random<Vector3>;
+using PhiloxRand = Random<Vector3, Philox>;
 
 // template machinery to test the presence of methods of G4ThreeVector
 namespace detail_rand
@@ -100,127 +113,889 @@ struct has_RotateX<T, void_t<decltype(std::declval<T>().RotateX(0.))>>:
     std::true_type {};
 }  // namespace detail_rand
 
-// the Random class, almost a namespace (everything is static!)
-template<class vector>
-class Random {
+/// Philox4x32-10, the counter-based engine of Salmon et al. (SC'11, Random123).
+/// The n-th number of a stream is computed directly from the key (the seed), the
+/// stream index and n, without any sequential state: any stream can be started at any
+/// position in constant time, e.g. to regenerate a single event.
+/// Each block of 128 bits, the encryption of the counter {n/2, stream}, gives two
+/// numbers of 64 bits. The blocks being independent, Generate encrypts 4 (AVX2) or 8
+/// (AVX-512) of them at once, the numbers being the same with any instructions.
+class Philox {
+public:
+    using result_type = std::uint64_t;
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    static constexpr std::uint32_t kM0 = 0xD2511F53, kM1 = 0xCD9E8D57;  // multipliers
+    static constexpr std::uint32_t kW0 = 0x9E3779B9, kW1 = 0xBB67AE85;  // key bumps
+
+    enum EInstructions { kScalar, kAVX2, kAVX512 };
+    // the best instructions of the CPU by default, it can be lowered (e.g. to compare)
+    static EInstructions GetInstructions();
+    static void SetInstructions(EInstructions instructions);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    explicit Philox(std::uint64_t key = 0, std::uint64_t stream = 0) {
+        seed(key, stream);
+    }
+
+    void seed(std::uint64_t key, std::uint64_t stream = 0) {
+        Keys = {
+            static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32)};
+        Stream = stream;
+        SetPosition(0);
+    }
+
+    inline result_type operator()() {
+        if (Index == 2) {
+            Fill(Block++);
+            Index = 0;
+        }
+        return Buffer[Index++];
+    }
+
+    // number of values drawn since the start of the stream
+    inline std::uint64_t GetPosition() const { return 2 * Block - (2 - Index); }
+    inline void SetPosition(std::uint64_t position) {
+        Block = position / 2;
+        Index = 2;
+        if (position % 2) {
+            Fill(Block++);
+            Index = 1;
+        }
+    }
+    inline void discard(unsigned long long n) { SetPosition(GetPosition() + n); }
+
+    // the next n numbers, as drawn one by one
+    void Generate(std::uint64_t* values, std::size_t n);
+    // the next n numbers as uniforms in [0, 1): their 53 high bits times 2^-53
+    void GenerateUniform(double* values, std::size_t n);
+
+    // the bijection itself: 10 rounds of multiplications and key bumps
+    static Counter Encrypt(Counter ctr, Key key) {
+        for (int round = 0; round < 10; round++) {
+            const std::uint64_t p0 = static_cast<std::uint64_t>(kM0) * ctr[0];
+            const std::uint64_t p1 = static_cast<std::uint64_t>(kM1) * ctr[2];
+            ctr = {
+                static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+                static_cast<std::uint32_t>(p1),
+                static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+                static_cast<std::uint32_t>(p0)};
+            key[0] += kW0;
+            key[1] += kW1;
+        }
+        return ctr;
+    }
+
+    // the numbers of nb successive blocks, without SIMD
+    static void EncryptBlocks(
+        const Key& key,
+        std::uint64_t stream,
+        std::uint64_t block,
+        std::size_t nb,
+        std::uint64_t* out) {
+        for (std::size_t b = 0; b != nb; b++) {
+            const Counter c = Encrypt(
+                {static_cast<std::uint32_t>(block + b),
+                 static_cast<std::uint32_t>((block + b) >> 32),
+                 static_cast<std::uint32_t>(stream),
+                 static_cast<std::uint32_t>(stream >> 32)},
+                key);
+            out[2 * b] = (static_cast<std::uint64_t>(c[1]) << 32) | c[0];
+            out[2 * b + 1] = (static_cast<std::uint64_t>(c[3]) << 32) | c[2];
+        }
+    }
+
+    friend bool operator==(const Philox& a, const Philox& b) {
+        return a.Keys == b.Keys and a.Stream == b.Stream
+               and a.GetPosition() == b.GetPosition();
+    }
+    friend bool operator!=(const Philox& a, const Philox& b) { return not(a == b); }
+
 private:
-    Random() = delete;
-    Random(Random&) = delete;
+    inline void Fill(std::uint64_t block) {
+        EncryptBlocks(Keys, Stream, block, 1, Buffer.data());
+    }
 
-    using clock_count_ts =
-        decltype(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-    static clock_count_ts theSeed;
-    static std::default_random_engine theGenerator;
-
-    static std::uniform_real_distribution<double> uniform_real_distro;
-    static std::normal_distribution<double> gaussian_distro;
-    static std::bernoulli_distribution bernouilli_distro;
-    static std::binomial_distribution<int> binomial_distro;
-    static std::geometric_distribution<int> geometric_distro;
-    static std::poisson_distribution<int> poisson_distro;
-    static std::exponential_distribution<double> exponential_distro;
-    static std::gamma_distribution<double> gamma_distro;
-    static std::chi_squared_distribution<double> chi2_distro;
-
-    static std::function<double(void)> UniformRand;
-    static std::function<double(void)> GaussianRand;
-    static std::function<bool(void)> BernouilliRand;
-    static std::function<int(void)> BinomialRand;
-    static std::function<int(void)> GeometricRand;
-    static std::function<int(void)> PoissonRand;
-    static std::function<double(void)> ExponentialRand;
-    static std::function<double(void)> GammaRand;
-    static std::function<double(void)> Chi2Rand;
+    Key Keys;
+    std::uint64_t Stream;
+    std::uint64_t Block;  // next block to encrypt
+    unsigned Index;  // next number of the buffer, 2 if it is used up
+    std::array<std::uint64_t, 2> Buffer;
+};
 
+namespace detail_rand
+{
+#ifdef RAND__X86_SIMD
+// 4 blocks at once, a block per 64 bits lane holding a 32 bits word of the counter
+__attribute__((target("avx2"))) inline void PhiloxBlocksAVX2(
+    const Philox::Key& key,
+    std::uint64_t stream,
+    std::uint64_t block,
+    std::size_t nb,
+    std::uint64_t* out) {
+    const __m256i mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i m0 = _mm256_set1_epi64x(Philox::kM0);
+    const __m256i m1 = _mm256_set1_epi64x(Philox::kM1);
+    const __m256i s0 = _mm256_set1_epi64x(static_cast<std::uint32_t>(stream));
+    const __m256i s1 = _mm256_set1_epi64x(stream >> 32);
+    const __m256i lanes = _mm256_setr_epi64x(0, 1, 2, 3);
+    std::size_t b = 0;
+    for (; b + 4 <= nb; b += 4) {
+        const __m256i ctr = _mm256_add_epi64(_mm256_set1_epi64x(block + b), lanes);
+        __m256i c0 = _mm256_and_si256(ctr, mask), c1 = _mm256_srli_epi64(ctr, 32);
+        __m256i c2 = s0, c3 = s1;
+        Philox::Key k = key;
+        for (int round = 0; round < 10; round++) {
+            const __m256i p0 = _mm256_mul_epu32(m0, c0);
+            const __m256i p1 = _mm256_mul_epu32(m1, c2);
+            const __m256i key0 = _mm256_set1_epi64x(k[0]);
+            const __m256i key1 = _mm256_set1_epi64x(k[1]);
+            const __m256i hi0 = _mm256_srli_epi64(p0, 32);
+            const __m256i hi1 = _mm256_srli_epi64(p1, 32);
+            c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), key0);
+            c1 = _mm256_and_si256(p1, mask);
+            c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), key1);
+            c3 = _mm256_and_si256(p0, mask);
+            k[0] += Philox::kW0;
+            k[1] += Philox::kW1;
+        }
+        // interleave the two numbers of each block
+        const __m256i lo = _mm256_or_si256(_mm256_slli_epi64(c1, 32), c0);
+        const __m256i hi = _mm256_or_si256(_mm256_slli_epi64(c3, 32), c2);
+        const __m256i even = _mm256_unpacklo_epi64(lo, hi);  // blocks 0 and 2
+        const __m256i odd = _mm256_unpackhi_epi64(lo, hi);  // blocks 1 and 3
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(out + 2 * b),
+            _mm256_permute2x128_si256(even, odd, 0x20));
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(out + 2 * b + 4),
+            _mm256_permute2x128_si256(even, odd, 0x31));
+    }
+    Philox::EncryptBlocks(key, stream, block + b, nb - b, out + 2 * b);
+}
+
+// 8 blocks at once, as above
+__attribute__((target("avx512f"))) inline void PhiloxBlocksAVX512(
+    const Philox::Key& key,
+    std::uint64_t stream,
+    std::uint64_t block,
+    std::size_t nb,
+    std::uint64_t* out) {
+    // the masked forms write every lane, where the plain ones pass an undefined source
+    // that GCC 12 reports as maybe uninitialized
+    constexpr __mmask8 all = 0xFF;
+    const __m512i mask = _mm512_set1_epi64(0xFFFFFFFF);
+    const __m512i m0 = _mm512_set1_epi64(Philox::kM0);
+    const __m512i m1 = _mm512_set1_epi64(Philox::kM1);
+    const __m512i s0 = _mm512_set1_epi64(static_cast<std::uint32_t>(stream));
+    const __m512i s1 = _mm512_set1_epi64(stream >> 32);
+    const __m512i lanes = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+    const __m512i first = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+    const __m512i second = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+    std::size_t b = 0;
+    for (; b + 8 <= nb; b += 8) {
+        const __m512i ctr = _mm512_add_epi64(_mm512_set1_epi64(block + b), lanes);
+        __m512i c0 = _mm512_and_si512(ctr, mask);
+        __m512i c1 = _mm512_maskz_srli_epi64(all, ctr, 32);
+        __m512i c2 = s0, c3 = s1;
+        Philox::Key k = key;
+        for (int round = 0; round < 10; round++) {
+            const __m512i p0 = _mm512_maskz_mul_epu32(all, m0, c0);
+            const __m512i p1 = _mm512_maskz_mul_epu32(all, m1, c2);
+            const __m512i key0 = _mm512_set1_epi64(k[0]);
+            const __m512i key1 = _mm512_set1_epi64(k[1]);
+            const __m512i hi0 = _mm512_maskz_srli_epi64(all, p0, 32);
+            const __m512i hi1 = _mm512_maskz_srli_epi64(all, p1, 32);
+            c0 = _mm512_xor_si512(_mm512_xor_si512(hi1, c1), key0);
+            c1 = _mm512_and_si512(p1, mask);
+            c2 = _mm512_xor_si512(_mm512_xor_si512(hi0, c3), key1);
+            c3 = _mm512_and_si512(p0, mask);
+            k[0] += Philox::kW0;
+            k[1] += Philox::kW1;
+        }
+        const __m512i lo = _mm512_or_si512(_mm512_maskz_slli_epi64(all, c1, 32), c0);
+        const __m512i hi = _mm512_or_si512(_mm512_maskz_slli_epi64(all, c3, 32), c2);
+        _mm512_storeu_si512(out + 2 * b, _mm512_permutex2var_epi64(lo, first, hi));
+        _mm512_storeu_si512(out + 2 * b + 8, _mm512_permutex2var_epi64(lo, second, hi));
+    }
+    Philox::EncryptBlocks(key, stream, block + b, nb - b, out + 2 * b);
+}
+#endif  // RAND__X86_SIMD
+
+inline Philox::EInstructions SupportedInstructions() {
+#ifdef RAND__X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return Philox::kAVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Philox::kAVX2;
+    }
+#endif
+    return Philox::kScalar;
+}
+
+inline std::atomic<Philox::EInstructions>& PhiloxInstructions() {
+    static std::atomic<Philox::EInstructions> instructions(SupportedInstructions());
+    return instructions;
+}
+}  // namespace detail_rand
+
+inline Philox::EInstructions Philox::GetInstructions() {
+    return detail_rand::PhiloxInstructions();
+}
+
+inline void Philox::SetInstructions(EInstructions instructions) {
+    detail_rand::PhiloxInstructions() =
+        std::min(instructions, detail_rand::SupportedInstructions());
+}
+
+inline void Philox::Generate(std::uint64_t* values, std::size_t n) {
+    std::size_t i = 0;
+    if (Index != 2 and n != 0) {  // the end of the current block
+        values[i++] = (*this)();
+    }
+    const std::size_t nb = (n - i) / 2;
+    switch (GetInstructions()) {
+#ifdef RAND__X86_SIMD
+        case kAVX512:
+            detail_rand::PhiloxBlocksAVX512(Keys, Stream, Block, nb, values + i);
+            break;
+        case kAVX2:
+            detail_rand::PhiloxBlocksAVX2(Keys, Stream, Block, nb, values + i);
+            break;
+#endif
+        default:
+            EncryptBlocks(Keys, Stream, Block, nb, values + i);
+            break;
+    }
+    Block += nb;
+    for (i += 2 * nb; i != n; i++) {
+        values[i] = (*this)();
+    }
+}
+
+inline void Philox::GenerateUniform(double* values, std::size_t n) {
+    constexpr std::size_t kChunk = 256;
+    std::uint64_t bits[kChunk];
+    for (std::size_t first = 0; first < n; first += kChunk) {
+        const std::size_t size = std::min(kChunk, n - first);
+        Generate(bits, size);
+        for (std::size_t i = 0; i != size; i++) {
+            values[first + i] = static_cast<double>(bits[i] >> 11) * 0x1.0p-53;
+        }
+    }
+}
+
+namespace detail_rand
+{
+// start a stream of a standard engine: its state is filled by a std::seed_seq
+template<class engine>
+void SeedEngine(engine& generator, std::uint64_t seed, std::uint64_t index) {
+    std::seed_seq seq{
+        static_cast<std::uint32_t>(seed),
+        static_cast<std::uint32_t>(seed >> 32),
+        static_cast<std::uint32_t>(index),
+        static_cast<std::uint32_t>(index >> 32)};
+    generator.seed(seq);
+}
+
+// start a stream of a counter-based engine: nothing to compute
+inline void SeedEngine(Philox& generator, std::uint64_t seed, std::uint64_t index) {
+    generator.seed(seed, index);
+}
+
+// uniform in [0, 1), from the 53 high bits of a 64 bits engine if possible
+template<class engine>
+inline double FastUniform(engine& generator) {
+    if constexpr (engine::min() == 0 and engine::max() == ~std::uint64_t(0)) {
+        return static_cast<double>(generator() >> 11) * 0x1.0p-53;
+    } else {
+        return std::generate_canonical<double, 53>(generator);
+    }
+}
+
+// 64 random bits
+template<class engine>
+inline std::uint64_t Bits64(engine& generator) {
+    if constexpr (engine::min() == 0 and engine::max() == ~std::uint64_t(0)) {
+        return generator();
+    } else {
+        return std::uniform_int_distribution<std::uint64_t>()(generator);
+    }
+}
+
+/// The layers of a Ziggurat (Marsaglia and Tsang, J. Stat. Softw. 5, 2000) of 256
+/// rectangles of equal areas under a decreasing density f: the layer i is
+/// [0, X[i]] x [F[i], F[i+1]], and the base layer (i = 0) holds the tail beyond
+/// X[1] = r in its width X[0] = v / f(r).
+struct Ziggurat {
+    static constexpr int kNbLayers = 256;
+    std::array<double, kNbLayers + 1> X;
+    std::array<double, kNbLayers + 1> F;
+
+    // tail: the area of the tail beyond r, inverse: the inverse of f
+    template<class density, class inverse>
+    Ziggurat(double r, double tail, density f, inverse f_inv) {
+        const double v = r * f(r) + tail;
+        X[0] = v / f(r);
+        F[0] = 0.;
+        X[1] = r;
+        F[1] = f(r);
+        for (int i = 1; i != kNbLayers - 1; i++) {
+            F[i + 1] = F[i] + v / X[i];
+            X[i + 1] = f_inv(F[i + 1]);
+        }
+        X[kNbLayers] = 0.;
+        F[kNbLayers] = 1.;
+    }
+};
+
+// the positive half of the normal density, unnormalised: exp(-x^2/2), r for 256 layers
+inline const Ziggurat& NormalZiggurat() {
+    static const Ziggurat ziggurat(
+        3.6541528853610088,
+        std::sqrt(Math::PiOver2()) * std::erfc(3.6541528853610088 / Math::Sqrt2()),
+        [](double x) { return std::exp(-0.5 * x * x); },
+        [](double y) { return std::sqrt(-2. * std::log(y)); });
+    return ziggurat;
+}
+
+// the exponential density exp(-x), r for 256 layers
+inline const Ziggurat& ExponentialZiggurat() {
+    static const Ziggurat ziggurat(
+        7.69711747013104972,
+        std::exp(-7.69711747013104972),
+        [](double x) { return std::exp(-x); },
+        [](double y) { return -std::log(y); });
+    return ziggurat;
+}
+
+// a standard normal number: 8 bits for the layer, 1 for the sign and 53 for x
+template<class engine>
+double ZigguratNormal(engine& generator) {
+    const Ziggurat& zig = NormalZiggurat();
+    while (true) {
+        const std::uint64_t bits = Bits64(generator);
+        const int i = bits & 0xFF;
+        const double sign = (bits & 0x100) ? -1. : 1.;
+        const double x = static_cast<double>(bits >> 11) * 0x1.0p-53 * zig.X[i];
+        if (x < zig.X[i + 1]) {  // inside the layer above: under the density
+            return sign * x;
+        }
+        if (i == 0) {  // the tail, by the method of Marsaglia (1964)
+            const double r = zig.X[1];
+            double a, b;
+            do {
+                a = -std::log(1. - FastUniform(generator)) / r;
+                b = -std::log(1. - FastUniform(generator));
+            } while (2. * b < a * a);
+            return sign * (r + a);
+        }
+        const double y = zig.F[i] + FastUniform(generator) * (zig.F[i + 1] - zig.F[i]);
+        if (y < std::exp(-0.5 * x * x)) {  // in the wedge, under the density
+            return sign * x;
+        }
+    }
+}
+
+// an exponential number of rate 1: 8 bits for the layer and 53 for x
+template<class engine>
+double ZigguratExponential(engine& generator) {
+    const Ziggurat& zig = ExponentialZiggurat();
+    while (true) {
+        const std::uint64_t bits = Bits64(generator);
+        const int i = bits & 0xFF;
+        const double x = static_cast<double>(bits >> 11) * 0x1.0p-53 * zig.X[i];
+        if (x < zig.X[i + 1]) {
+            return x;
+        }
+        if (i == 0) {  // the tail, memoryless
+            return zig.X[1] - std::log(1. - FastUniform(generator));
+        }
+        const double y = zig.F[i] + FastUniform(generator) * (zig.F[i + 1] - zig.F[i]);
+        if (y < std::exp(-x)) {
+            return x;
+        }
+    }
+}
+}  // namespace detail_rand
+
+/// A stream of random numbers: an engine and the distributions drawing from it.
+/// The streams built from the same seed with different indices are independent: the
+/// state of each engine is filled from the seed and the index by a std::seed_seq, or
+/// they are the disjoint sequences of counters of Philox.
+/// A stream is not thread-safe, each thread must draw from its own stream.
+template<class engine = std::mt19937_64>
+class BasicRandomStream {
 public:
-    enum Axis {
-        X = 0,
-        Y = 1,
-        Z = 2
-    };
+    using Engine = engine;
+    using seed_t = std::uint64_t;
 
-    inline static auto GetSeed() -> decltype(theSeed) { return theSeed; }
-    inline static auto GetGenerator() -> decltype(theGenerator) { return theGenerator; }
+    // the bulk generation yields the numbers of the successive single draws, or faster
+    // but different numbers (same distributions) when it has a faster algorithm
+    enum EFill { kExact, kFast };
+    // the algorithm of Gauss and Exp: the one of the standard library, or the Ziggurat,
+    // faster, with the same distributions but other numbers
+    enum EAlgorithm { kStandard, kZiggurat };
 
-    inline static double Uniform() { return uniform_real_distro(theGenerator); }
-    inline static double Uniform(double max) {
-        return max * uniform_real_distro(theGenerator);
+    BasicRandomStream(seed_t seed, seed_t index) { Seed(seed, index); }
+
+    // restart the stream, forgetting the state of the distributions
+    void Seed(seed_t seed, seed_t index) {
+        detail_rand::SeedEngine(Generator, seed, index);
+        uniform_real_distro.reset();
+        gaussian_distro.reset();
+        bernouilli_distro.reset();
+        binomial_distro.reset();
+        geometric_distro.reset();
+        poisson_distro.reset();
+        exponential_distro.reset();
+        gamma_distro.reset();
+        chi2_distro.reset();
     }
-    inline static double Uniform(double min, double max) {
-        return min + (max - min) * uniform_real_distro(theGenerator);
+
+    inline Engine& GetGenerator() { return Generator; }
+    inline EAlgorithm GetAlgorithm() const { return Algorithm; }
+    inline void SetAlgorithm(EAlgorithm algorithm) { Algorithm = algorithm; }
+
+    inline double Uniform() { return uniform_real_distro(Generator); }
+    inline double Uniform(double max) { return max * uniform_real_distro(Generator); }
+    inline double Uniform(double min, double max) {
+        return min + (max - min) * uniform_real_distro(Generator);
     }
 
-    inline static double Gauss() { return gaussian_distro(theGenerator); }
-    inline static void SetGaussPar(double mean, double stddev) {
+    inline double Gauss() {
+        if (Algorithm == kZiggurat) {
+            return gaussian_distro.mean()
+                   + gaussian_distro.stddev() * detail_rand::ZigguratNormal(Generator);
+        }
+        return gaussian_distro(Generator);
+    }
+    inline void SetGaussPar(double mean, double stddev) {
         gaussian_distro.param(
             std::normal_distribution<double>::param_type(mean, stddev));
     }
-    inline static double Gauss(double mean, double stddev) {
-        return mean + stddev * gaussian_distro(theGenerator);
-    }
+    inline double Gauss(double mean, double stddev) { return mean + stddev * Gauss(); }
 
-    inline static bool Bernouilli() { return bernouilli_distro(theGenerator); }
-    inline static void SetBernouilliPar(double p) {
+    inline bool Bernouilli() { return bernouilli_distro(Generator); }
+    inline void SetBernouilliPar(double p) {
         bernouilli_distro.param(std::bernoulli_distribution::param_type(p));
     }
-    inline static bool Bernouilli(double p) {
+    inline bool Bernouilli(double p) {
         SetBernouilliPar(p);
-        return bernouilli_distro(theGenerator);
+        return bernouilli_distro(Generator);
     }
 
-    inline static int Binomial() { return binomial_distro(theGenerator); }
-    inline static void SetBinomialPar(int t, double p) {
+    inline int Binomial() { return binomial_distro(Generator); }
+    inline void SetBinomialPar(int t, double p) {
         binomial_distro.param(std::binomial_distribution<int>::param_type(t, p));
     }
-    inline static int Binomial(int t, double p) {
+    inline int Binomial(int t, double p) {
         SetBinomialPar(t, p);
-        return binomial_distro(theGenerator);
+        return binomial_distro(Generator);
     }
 
-    inline static int Geometric() { return geometric_distro(theGenerator); }
-    inline static void SetGeometric(double p) {
+    inline int Geometric() { return geometric_distro(Generator); }
+    inline void SetGeometric(double p) {
         geometric_distro.param(std::geometric_distribution<int>::param_type(p));
     }
-    inline static int Geometric(double p) {
+    inline int Geometric(double p) {
         SetGeometric(p);
-        return geometric_distro(theGenerator);
+        return geometric_distro(Generator);
     }
 
-    inline static int Poisson() { return poisson_distro(theGenerator); }
-    inline static void SetPoissonPar(double mean) {
+    inline int Poisson() { return poisson_distro(Generator); }
+    inline void SetPoissonPar(double mean) {
         poisson_distro.param(std::poisson_distribution<int>::param_type(mean));
     }
-    inline static int Poisson(double mean) {
+    inline int Poisson(double mean) {
         SetPoissonPar(mean);
-        return poisson_distro(theGenerator);
+        return poisson_distro(Generator);
     }
 
-    inline static double Exp() { return exponential_distro(theGenerator); }
-    inline static void SetExpPar(double lambda) {
+    inline double Exp() {
+        if (Algorithm == kZiggurat) {
+            const double x = detail_rand::ZigguratExponential(Generator);
+            return x / exponential_distro.lambda();
+        }
+        return exponential_distro(Generator);
+    }
+    inline void SetExpPar(double lambda) {
         exponential_distro.param(
             std::exponential_distribution<double>::param_type(lambda));
     }
-    inline static double Exp(double lambda) {
+    inline double Exp(double lambda) {
         SetExpPar(lambda);
-        return exponential_distro(theGenerator);
+        return Exp();
     }
 
-    inline static double Gamma() { return gamma_distro(theGenerator); }
-    inline static void SetGammaPar(double alpha, double beta) {
+    inline double Gamma() { return gamma_distro(Generator); }
+    inline void SetGammaPar(double alpha, double beta) {
         gamma_distro.param(std::gamma_distribution<double>::param_type(alpha, beta));
     }
-    inline static double Gamma(double alpha, double beta) {
+    inline double Gamma(double alpha, double beta) {
         SetGammaPar(alpha, beta);
-        return gamma_distro(theGenerator);
+        return gamma_distro(Generator);
     }
 
-    inline static double Chi2() { return chi2_distro(theGenerator); }
-    inline static void SetChi2Par(double n) {
+    inline double Chi2() { return chi2_distro(Generator); }
+    inline void SetChi2Par(double n) {
         chi2_distro.param(std::chi_squared_distribution<double>::param_type(n));
     }
-    inline static double Chi2(double n) {
+    inline double Chi2(double n) {
         SetChi2Par(n);
-        return chi2_distro(theGenerator);
+        return chi2_distro(Generator);
+    }
+
+public:  // Fill arrays, with the current parameters or the given ones
+    void FillUniform(double* values, std::size_t n, EFill mode = kExact) {
+        if (mode == kFast) {
+            FillFastUniform(values, n);
+        } else {
+            for (std::size_t i = 0; i != n; i++) {
+                values[i] = uniform_real_distro(Generator);
+            }
+        }
+    }
+    void FillUniform(
+        double* values, std::size_t n, double min, double max, EFill mode = kExact) {
+        FillUniform(values, n, mode);
+        for (std::size_t i = 0; i != n; i++) {
+            values[i] = min + (max - min) * values[i];
+        }
+    }
+
+    // fast mode: Box-Muller, without rejection nor cache
+    void FillGauss(double* values, std::size_t n, EFill mode = kExact) {
+        if (mode == kExact) {
+            for (std::size_t i = 0; i != n; i++) {
+                values[i] = Gauss();
+            }
+            return;
+        }
+        const double mean = gaussian_distro.mean(), stddev = gaussian_distro.stddev();
+        double uniforms[kChunk];
+        for (std::size_t first = 0; first < n; first += kChunk) {
+            const std::size_t size = std::min(kChunk, n - first);
+            FillFastUniform(uniforms, size + size % 2);
+            for (std::size_t i = 0; i < size; i += 2) {
+                const double r = stddev * std::sqrt(-2. * std::log(1. - uniforms[i]));
+                const double phi = Math::TwoPi() * uniforms[i + 1];
+                values[first + i] = mean + r * std::cos(phi);
+                if (i + 1 != size) {
+                    values[first + i + 1] = mean + r * std::sin(phi);
+                }
+            }
+        }
+    }
+    void FillGauss(
+        double* values,
+        std::size_t n,
+        double mean,
+        double stddev,
+        EFill mode = kExact) {
+        FillGauss(values, n, mode);
+        for (std::size_t i = 0; i != n; i++) {
+            values[i] = mean + stddev * values[i];
+        }
+    }
+
+    void FillBernouilli(bool* values, std::size_t n, EFill mode = kExact) {
+        if (mode == kFast) {
+            const double p = bernouilli_distro.p();
+            double uniforms[kChunk];
+            for (std::size_t first = 0; first < n; first += kChunk) {
+                const std::size_t size = std::min(kChunk, n - first);
+                FillFastUniform(uniforms, size);
+                for (std::size_t i = 0; i != size; i++) {
+                    values[first + i] = uniforms[i] < p;
+                }
+            }
+        } else {
+            for (std::size_t i = 0; i != n; i++) {
+                values[i] = bernouilli_distro(Generator);
+            }
+        }
+    }
+    void FillBernouilli(bool* values, std::size_t n, double p, EFill mode = kExact) {
+        SetBernouilliPar(p);
+        FillBernouilli(values, n, mode);
+    }
+
+    // no faster algorithm: the fast mode is the exact one
+    void FillBinomial(int* values, std::size_t n, EFill = kExact) {
+        for (std::size_t i = 0; i != n; i++) {
+            values[i] = binomial_distro(Generator);
+        }
+    }
+    void FillBinomial(int* values, std::size_t n, int t, double p, EFill = kExact) {
+        SetBinomialPar(t, p);
+        FillBinomial(values, n);
+    }
+
+    // fast mode: inversion of the fast uniforms
+    void FillGeometric(int* values, std::size_t n, EFill mode = kExact) {
+        if (mode == kExact) {
+            for (std::size_t i = 0; i != n; i++) {
+                values[i] = geometric_distro(Generator);
+            }
+            return;
+        }
+        const double inv_log_q = 1. / std::log1p(-geometric_distro.p());
+        constexpr double max = std::numeric_limits<int>::max();
+        for (std::size_t i = 0; i != n; i++) {
+            double candidate;
+            do {
+                candidate = std::floor(
+                    std::log(1. - detail_rand::FastUniform(Generator)) * inv_log_q);
+            } while (candidate >= max);
+            values[i] = static_cast<int>(candidate);
+        }
+    }
+    void FillGeometric(int* values, std::size_t n, double p, EFill mode = kExact) {
+        SetGeometric(p);
+        FillGeometric(values, n, mode);
+    }
+
+    // no faster algorithm: the fast mode is the exact one
+    void FillPoisson(int* values, std::size_t n, EFill = kExact) {
+        for (std::size_t i = 0; i != n; i++) {
+            values[i] = poisson_distro(Generator);
+        }
+    }
+    void FillPoisson(int* values, std::size_t n, double mean, EFill = kExact) {
+        SetPoissonPar(mean);
+        FillPoisson(values, n);
+    }
+
+    // fast mode: inversion of the fast uniforms
+    void FillExp(double* values, std::size_t n, EFill mode = kExact) {
+        if (mode == kFast) {
+            const double inv_lambda = 1. / exponential_distro.lambda();
+            FillFastUniform(values, n);
+            for (std::size_t i = 0; i != n; i++) {
+                values[i] = -std::log(1. - values[i]) * inv_lambda;
+            }
+        } else {
+            for (std::size_t i = 0; i != n; i++) {
+                values[i] = Exp();
+            }
+        }
+    }
+    void FillExp(double* values, std::size_t n, double lambda, EFill mode = kExact) {
+        SetExpPar(lambda);
+        FillExp(values, n, mode);
+    }
+
+    // no faster algorithm: the fast mode is the exact one
+    void FillGamma(double* values, std::size_t n, EFill = kExact) {
+        for (std::size_t i = 0; i != n; i++) {
+            values[i] = gamma_distro(Generator);
+        }
+    }
+    void FillGamma(
+        double* values, std::size_t n, double alpha, double beta, EFill = kExact) {
+        SetGammaPar(alpha, beta);
+        FillGamma(values, n);
+    }
+
+    // no faster algorithm: the fast mode is the exact one
+    void FillChi2(double* values, std::size_t n, EFill = kExact) {
+        for (std::size_t i = 0; i != n; i++) {
+            values[i] = chi2_distro(Generator);
+        }
+    }
+    void FillChi2(double* values, std::size_t n, double k, EFill = kExact) {
+        SetChi2Par(k);
+        FillChi2(values, n);
+    }
+
+private:
+    static constexpr std::size_t kChunk = 256;  // uniforms drawn at once in fast mode
+
+    // the uniforms of the fast mode, in bulk (and SIMD) for Philox
+    void FillFastUniform(double* values, std::size_t n) {
+        if constexpr (std::is_same<engine, Philox>::value) {
+            Generator.GenerateUniform(values, n);
+        } else {
+            for (std::size_t i = 0; i != n; i++) {
+                values[i] = detail_rand::FastUniform(Generator);
+            }
+        }
+    }
+
+    Engine Generator;
+    EAlgorithm Algorithm = kStandard;
+
+    std::uniform_real_distribution<double> uniform_real_distro{0., 1.};
+    std::normal_distribution<double> gaussian_distro{0., 1.};
+    std::bernoulli_distribution bernouilli_distro{0.5};
+    std::binomial_distribution<int> binomial_distro{1, 0.5};
+    std::geometric_distribution<int> geometric_distro{0.5};
+    std::poisson_distribution<int> poisson_distro{1.};
+    std::exponential_distribution<double> exponential_distro{1.};
+    std::gamma_distribution<double> gamma_distro{1., 1.};
+    std::chi_squared_distribution<double> chi2_distro{1.};
+};
+
+using RandomStream = BasicRandomStream<>;
+using PhiloxStream = BasicRandomStream<Philox>;
+
+// the Random class, almost a namespace (everything is static!)
+// Each thread draws from its own stream, built from the common seed and an index
+// given in the order in which the threads first draw, unless the thread sets it with
+// SetStreamIndex (to be reproducible whatever the scheduling).
+// With the Philox engine, SetStreamIndex costs nothing: the stream of an event can be
+// set at its start, and the event regenerated alone from its number.
+template<class vector, class engine>
+class Random {
+private:
+    Random() = delete;
+    Random(Random&) = delete;
+
+public:
+    using Stream = BasicRandomStream<engine>;
+    using seed_t = typename Stream::seed_t;
+
+private:
+    static std::atomic<seed_t> theSeed;
+    static std::atomic<seed_t> theNbStreams;  // index of the next stream of a thread
+    static std::atomic<unsigned> theGeneration;  // incremented by SetSeed
+
+public:
+    enum Axis {
+        X = 0,
+        Y = 1,
+        Z = 2
+    };
+
+    inline static seed_t GetSeed() { return theSeed; }
+    // restart all the streams from this seed, the threads being numbered again
+    inline static void SetSeed(seed_t seed) {
+        theSeed = seed;
+        theNbStreams = 0;
+        theGeneration++;
+    }
+    // restart the stream of the calling thread at this index
+    inline static void SetStreamIndex(seed_t index) {
+        GetStream().Seed(theSeed, index);
+    }
+
+    // the stream of the calling thread
+    inline static Stream& GetStream() {
+        thread_local unsigned generation = theGeneration;
+        thread_local Stream stream(theSeed, theNbStreams++);
+        if (generation != theGeneration.load(std::memory_order_relaxed)) {
+            generation = theGeneration;
+            stream.Seed(theSeed, theNbStreams++);
+        }
+        return stream;
+    }
+    inline static engine& GetGenerator() {
+        return GetStream().GetGenerator();
+    }
+
+    // the algorithm of Gauss and Exp in the calling thread, see BasicRandomStream
+    using EAlgorithm = typename Stream::EAlgorithm;
+    static constexpr EAlgorithm kStandard = Stream::kStandard;
+    static constexpr EAlgorithm kZiggurat = Stream::kZiggurat;
+    inline static EAlgorithm GetAlgorithm() { return GetStream().GetAlgorithm(); }
+    inline static void SetAlgorithm(EAlgorithm algorithm) {
+        GetStream().SetAlgorithm(algorithm);
+    }
+
+    inline static double Uniform() { return GetStream().Uniform(); }
+    inline static double Uniform(double max) { return GetStream().Uniform(max); }
+    inline static double Uniform(double min, double max) {
+        return GetStream().Uniform(min, max);
+    }
+
+    inline static double Gauss() { return GetStream().Gauss(); }
+    inline static void SetGaussPar(double mean, double stddev) {
+        GetStream().SetGaussPar(mean, stddev);
+    }
+    inline static double Gauss(double mean, double stddev) {
+        return GetStream().Gauss(mean, stddev);
+    }
+
+    inline static bool Bernouilli() { return GetStream().Bernouilli(); }
+    inline static void SetBernouilliPar(double p) { GetStream().SetBernouilliPar(p); }
+    inline static bool Bernouilli(double p) { return GetStream().Bernouilli(p); }
+
+    inline static int Binomial() { return GetStream().Binomial(); }
+    inline static void SetBinomialPar(int t, double p) {
+        GetStream().SetBinomialPar(t, p);
+    }
+    inline static int Binomial(int t, double p) { return GetStream().Binomial(t, p); }
+
+    inline static int Geometric() { return GetStream().Geometric(); }
+    inline static void SetGeometric(double p) { GetStream().SetGeometric(p); }
+    inline static int Geometric(double p) { return GetStream().Geometric(p); }
+
+    inline static int Poisson() { return GetStream().Poisson(); }
+    inline static void SetPoissonPar(double mean) { GetStream().SetPoissonPar(mean); }
+    inline static int Poisson(double mean) { return GetStream().Poisson(mean); }
+
+    inline static double Exp() { return GetStream().Exp(); }
+    inline static void SetExpPar(double lambda) { GetStream().SetExpPar(lambda); }
+    inline static double Exp(double lambda) { return GetStream().Exp(lambda); }
+
+    inline static double Gamma() { return GetStream().Gamma(); }
+    inline static void SetGammaPar(double alpha, double beta) {
+        GetStream().SetGammaPar(alpha, beta);
+    }
+    inline static double Gamma(double alpha, double beta) {
+        return GetStream().Gamma(alpha, beta);
+    }
+
+    inline static double Chi2() { return GetStream().Chi2(); }
+    inline static void SetChi2Par(double n) { GetStream().SetChi2Par(n); }
+    inline static double Chi2(double n) { return GetStream().Chi2(n); }
+
+public:  // Fill arrays, see BasicRandomStream
+    using EFill = typename Stream::EFill;
+    static constexpr EFill kExact = Stream::kExact;
+    static constexpr EFill kFast = Stream::kFast;
+
+    template<class... Args>
+    inline static void FillUniform(double* values, std::size_t n, Args... args) {
+        GetStream().FillUniform(values, n, args...);
+    }
+    template<class... Args>
+    inline static void FillGauss(double* values, std::size_t n, Args... args) {
+        GetStream().FillGauss(values, n, args...);
+    }
+    template<class... Args>
+    inline static void FillBernouilli(bool* values, std::size_t n, Args... args) {
+        GetStream().FillBernouilli(values, n, args...);
+    }
+    template<class... Args>
+    inline static void FillBinomial(int* values, std::size_t n, Args... args) {
+        GetStream().FillBinomial(values, n, args...);
+    }
+    template<class... Args>
+    inline static void FillGeometric(int* values, std::size_t n, Args... args) {
+        GetStream().FillGeometric(values, n, args...);
+    }
+    template<class... Args>
+    inline static void FillPoisson(int* values, std::size_t n, Args... args) {
+        GetStream().FillPoisson(values, n, args...);
+    }
+    template<class... Args>
+    inline static void FillExp(double* values, std::size_t n, Args... args) {
+        GetStream().FillExp(values, n, args...);
+    }
+    template<class... Args>
+    inline static void FillGamma(double* values, std::size_t n, Args... args) {
+        GetStream().FillGamma(values, n, args...);
+    }
+    template<class... Args>
+    inline static void FillChi2(double* values, std::size_t n, Args... args) {
+        GetStream().FillChi2(values, n, args...);
     }
 
 public:  // Shoot a direction
@@ -230,9 +1005,9 @@ public:  // Shoot a direction
     inline static const vector Sphere(double r) { return std::move(Sphere(r, {})); }
 
     static const vector Cylinder(
-        double rho, double hh, const vector& center, Random<vector>::Axis axis = Z);
+        double rho, double hh, const vector& center, Axis axis = Z);
     inline static const vector Cylinder(
-        double rho, double hh, Random<vector>::Axis axis = Z) {
+        double rho, double hh, Axis axis = Z) {
         return std::move(Cylinder(rho, hh, axis, {}));
     }
 
@@ -273,7 +1048,7 @@ private:
     // With setRhoPhiZ
     template<typename T = vector>
     static auto SetCylindricalCoordinate(
-        T& v, double rho, double hh, const Random<vector>::Axis& axis) ->
+        T& v, double rho, double hh, const Axis& axis) ->
         typename std::enable_if<detail_rand::has_setRhoPhiZ<T>{}>::type {
         v.setRhoPhiZ(
             rho * Uniform(), Math::TwoPi() * Uniform(), hh * (2. * Uniform() - 1.));
@@ -283,7 +1058,7 @@ private:
     // With SetRhoPhiZ
     template<typename T = vector>
     static auto SetCylindricalCoordinate(
-        T& v, double rho, double hh, const Random<vector>::Axis& axis) ->
+        T& v, double rho, double hh, const Axis& axis) ->
         typename std::enable_if<detail_rand::has_SetRhoPhiZ<T>{}>::type {
         v.SetRhoPhiZ(
             rho * Uniform(), Math::TwoPi() * Uniform(), hh * (2. * Uniform() - 1.));
@@ -293,7 +1068,7 @@ private:
     // None of the above, provoque a compilation error with a meaningful message
     template<typename T = vector>
     static auto SetCylindricalCoordinate(
-        T& v, double rho, double hh, const Random<vector>::Axis& axis) ->
+        T& v, double rho, double hh, const Axis& axis) ->
         typename std::enable_if<
             not detail_rand::has_setRhoPhiZ<T>{}
             and not detail_rand::has_SetRhoPhiZ<T>{}>::type {
@@ -305,7 +1080,7 @@ private:
     /// Rotation
     // With rotateX
     template<typename T = vector>
-    static auto SetRotation(T& v, const Random<vector>::Axis& axis) ->
+    static auto SetRotation(T& v, const Axis& axis) ->
         typename std::enable_if<detail_rand::has_rotateX<T>{}>::type {
         switch (axis) {
             case X:
@@ -321,7 +1096,7 @@ private:
 
     // With RotateX
     template<typename T = vector>
-    static auto SetRotation(T& v, const Random<vector>::Axis& axis) ->
+    static auto SetRotation(T& v, const Axis& axis) ->
         typename std::enable_if<detail_rand::has_RotateX<T>{}>::type {
         switch (axis) {
             case X:
@@ -337,7 +1112,7 @@ private:
 
     // None of the above, provoque a compilation error with a meaningful message
     template<typename T = vector>
-    static auto SetRotation(T& v, const Random<vector>::Axis& axis) ->
+    static auto SetRotation(T& v, const Axis& axis) ->
         typename std::enable_if<
             not detail_rand::has_rotateX<T>{}
             and not detail_rand::has_RotateX<T>{}>::type {
@@ -377,85 +1152,37 @@ private:
 };
 
 /// initialisation of members (static but template so in header)
-template<class vector>
-typename Random<vector>::clock_count_ts Random<vector>::theSeed =
-    std::chrono::high_resolution_clock::now().time_since_epoch().count();
-template<class vector>
-std::default_random_engine Random<vector>::theGenerator(theSeed);
-
-template<class vector>
-std::uniform_real_distribution<double> Random<vector>::uniform_real_distro(0., 1.);
-template<class vector>
-std::normal_distribution<double> Random<vector>::gaussian_distro(0., 1.);
-template<class vector>
-std::bernoulli_distribution Random<vector>::bernouilli_distro(0.5);
-template<class vector>
-std::binomial_distribution<int> Random<vector>::binomial_distro(1l, 0.5);
-template<class vector>
-std::geometric_distribution<int> Random<vector>::geometric_distro(0.5);
-template<class vector>
-std::poisson_distribution<int> Random<vector>::poisson_distro(1.);
-template<class vector>
-std::exponential_distribution<double> Random<vector>::exponential_distro(1.);
-template<class vector>
-std::gamma_distribution<double> Random<vector>::gamma_distro(1., 1.);
-template<class vector>
-std::chi_squared_distribution<double> Random<vector>::chi2_distro(1.);
-
-// Bindings of the distributions and the generator, for convenient use,
-// but std::function is slow, prefer distro(theGenerator) if performance is a real
-// concern
-template<class vector>
-std::function<double(void)> Random<vector>::UniformRand =
-    std::bind(uniform_real_distro, theGenerator);
-template<class vector>
-std::function<double(void)> Random<vector>::GaussianRand =
-    std::bind(gaussian_distro, theGenerator);
-template<class vector>
-std::function<bool(void)> Random<vector>::BernouilliRand =
-    std::bind(bernouilli_distro, theGenerator);
-template<class vector>
-std::function<int(void)> Random<vector>::BinomialRand =
-    std::bind(binomial_distro, theGenerator);
-template<class vector>
-std::function<int(void)> Random<vector>::GeometricRand =
-    std::bind(geometric_distro, theGenerator);
-template<class vector>
-std::function<int(void)> Random<vector>::PoissonRand =
-    std::bind(poisson_distro, theGenerator);
-template<class vector>
-std::function<double(void)> Random<vector>::ExponentialRand =
-    std::bind(exponential_distro, theGenerator);
-template<class vector>
-std::function<double(void)> Random<vector>::GammaRand =
-    std::bind(gamma_distro, theGenerator);
-template<class vector>
-std::function<double(void)> Random<vector>::Chi2Rand =
-    std::bind(chi2_distro, theGenerator);
+template<class vector, class engine>
+std::atomic<typename Random<vector, engine>::seed_t> Random<vector, engine>::theSeed(
+    std::chrono::high_resolution_clock::now().time_since_epoch().count());
+template<class vector, class engine>
+std::atomic<typename Random<vector, engine>::seed_t>
+    Random<vector, engine>::theNbStreams(0);
+template<class vector, class engine>
+std::atomic<unsigned> Random<vector, engine>::theGeneration(0);
 
 /// definition of method non depending on the actual type of vector
 // Direction
-template<class vector>
-const vector Random<vector>::Direction() {
+template<class vector, class engine>
+const vector Random<vector, engine>::Direction() {
     vector v;
     SetSphericalCoordinate(v);
     return std::move(v);
 }
 
 // Sphere
-template<class vector>
-inline const vector Random<vector>::Sphere(double r, const vector& center) {
+template<class vector, class engine>
+inline const vector Random<vector, engine>::Sphere(double r, const vector& center) {
     constexpr double one_third = 1. / 3.;
     vector v(center);
-    v += std::pow(uniform_real_distro(theGenerator) * r * r * r, one_third)
-         * Direction();
+    v += std::pow(Uniform() * r * r * r, one_third) * Direction();
     return std::move(v);
 }
 
 // Cylinder
-template<class vector>
-inline const vector Random<vector>::Cylinder(
-    double rho, double hh, const vector& center, Random<vector>::Axis axis) {
+template<class vector, class engine>
+inline const vector Random<vector, engine>::Cylinder(
+    double rho, double hh, const vector& center, Axis axis) {
     vector v;
     SetCylindricalCoordinate(v, rho, hh, axis);
     v += center;
@@ -463,8 +1190,8 @@ inline const vector Random<vector>::Cylinder(
 }
 
 // Cuboid
-template<class vector>
-inline const vector Random<vector>::Cuboid(
+template<class vector, class engine>
+inline const vector Random<vector, engine>::Cuboid(
     double a, double b, double c, const vector& center) {
     vector v;
     SetCartesianCoordinate(v, a, b, c);
@@ -138,11 +138,12 @@ constexpr static hash_t prime = 0x100000001B3ull;
 constexpr static hash_t basis = 0xCBF29CE484222325ull;
 }  // namespace detail_string
 
-//! constexpr hash function
+//! constexpr hash function (FNV-1a), also fast enough to be used at run time
 constexpr hash_t strhash(std::string_view str, hash_t last_val = detail_string::basis) {
-    return not str.empty() ? strhash(
-               str.data() + 1, (str.front() ^ last_val) * detail_string::prime)
-                           : last_val;
+    for (char c : str) {
+        last_val = (c ^ last_val) * detail_string::prime;
+    }
+    return last_val;
 }
 //! operator _hash intended for constexpr hash of C-string
 constexpr hash_t operator"" _hash(const char* const p, size_t) {
@@ -11,10 +11,29 @@
 
 #include "DataBase.hh"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "Regex.hh"
@@ -44,6 +63,95 @@ using std::vector;
 ////////////////////////////////////////////////////////////////
 
 DataBase* DataBase::theDataBase = nullptr;
+std::atomic<const DataBase*> DataBase::thePublished = nullptr;
+std::atomic<const DataBase*> DataBase::theReferenced = nullptr;
+shared_ptr<const DataBase> DataBase::theSnapshot;
+vector<shared_ptr<const DataBase>> DataBase::theRetired;
+std::mutex DataBase::theMutex;
+std::mutex DataBase::theReloadMutex;
+
+////////////////////////////////////////////////////////////////
+DataBase* DataBase::GetInputDataBasePtr() {
+    std::lock_guard<std::mutex> lock(theMutex);
+    if (theDataBase == nullptr) {
+        if (theSnapshot) {
+            theDataBase = new DataBase(*theSnapshot, false);
+        } else {
+            theDataBase = new DataBase(false);
+        }
+    } else if (not theSnapshot) {
+        theDataBase->IsReadOnly = false;
+    }
+    return theDataBase;
+}
+
+////////////////////////////////////////////////////////////////
+void DataBase::Publish() {
+    std::lock_guard<std::mutex> lock(theMutex);
+    if (theDataBase == nullptr) {
+        if (theSnapshot) {
+            return;  // nothing new to publish
+        }
+        theDataBase = new DataBase(true);
+    }
+    PublishLocked(theDataBase);
+    theDataBase = nullptr;
+}
+
+////////////////////////////////////////////////////////////////
+// The previous version is kept alive if GetDataBase returned it, a single version
+// per call which saw a new one: theReferenced is only written with theMutex locked,
+// so a reader which did not lock it has seen the value tested here
+void DataBase::PublishLocked(DataBase* database) {
+    database->IsReadOnly = true;
+    database->Version = theSnapshot ? theSnapshot->Version + 1 : 1;
+    shared_ptr<const DataBase> previous = std::move(theSnapshot);
+    theSnapshot.reset(database);
+    thePublished.store(database);
+    if (previous and theReferenced.load() == previous.get()) {
+        theRetired.push_back(std::move(previous));
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// Without lock once the published version is known to be referenced, so only the
+// first call after a Publish or a Reload locks theMutex
+DataBase const* DataBase::GetDataBasePtr() {
+    const DataBase* published = thePublished.load();
+    if (published != nullptr and published == theReferenced.load()) {
+        return published;
+    }
+
+    std::lock_guard<std::mutex> lock(theMutex);
+    published = thePublished.load();
+    if (published != nullptr) {
+        theReferenced.store(published);
+        return published;
+    }
+
+    // Nothing published yet: the single instance is switched to read-only, and it
+    // is the version published first
+    if (theDataBase == nullptr) {
+        theDataBase = new DataBase(true);
+    } else {
+        theDataBase->IsReadOnly = true;
+    }
+    theReferenced.store(theDataBase);
+    return theDataBase;
+}
+
+////////////////////////////////////////////////////////////////
+shared_ptr<const DataBase> DataBase::GetSnapshot() {
+    std::lock_guard<std::mutex> lock(theMutex);
+    if (not theSnapshot) {
+        if (theDataBase == nullptr) {
+            theDataBase = new DataBase(true);
+        }
+        PublishLocked(theDataBase);
+        theDataBase = nullptr;
+    }
+    return theSnapshot;
+}
 
 ////////////////////////////////////////////////////////////////
 // Get the absolute path from environment
@@ -61,6 +169,862 @@ string DataBase::GetPath(const char* env_path) const {
     return cat(env, "/");
 }
 
+////////////////////////////////////////////////////////////////
+/* Hand-written tokenizer, reproducing exactly the behaviour of the regular expressions
+ * of the legacy parser, character class by character class (ECMAScript grammar):
+ *   comment: \s*#.*$
+ *   line:    ^(\w+)(\s+([+-]?\d+(\.\d*)?([eE][+-]?\d+)?))?(\s+(.+))?
+ *   table:   =(\w+)= for the name, ^=\w+=\s* for the header, \s+ for the rows
+ */
+namespace detail_database
+{
+inline bool IsSpace(char c) {
+    return std::isspace(static_cast<unsigned char>(c));
+}
+inline bool IsDigit(char c) {
+    return std::isdigit(static_cast<unsigned char>(c));
+}
+inline bool IsWord(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) or c == '_';
+}
+// characters not matched by '.'
+inline bool IsLineEnd(char c) {
+    return c == '\n' or c == '\r';
+}
+
+/// The fields of a parameter line, empty if not present
+struct LineFields {
+    std::string_view Key;
+    std::string_view Number;
+    std::string_view Text;
+};
+
+// Position of the comment to remove from str, npos if none
+size_t FindComment(std::string_view str) {
+    for (size_t pos = str.find('#'); pos != string::npos;
+         pos = str.find('#', pos + 1)) {
+        if (str.find_first_of("\r\n", pos + 1) == string::npos) {
+            while (pos > 0 and IsSpace(str[pos - 1])) {
+                pos--;
+            }
+            return pos;
+        }
+    }
+    return string::npos;
+}
+
+// Remove the comment and the spaces before it
+void StripComment(std::string_view& str) {
+    for (size_t pos = FindComment(str); pos != string::npos; pos = FindComment(str)) {
+        str.remove_suffix(str.size() - pos);
+    }
+}
+
+// End of the number beginning at start in str: [+-]digits[.,digits][eE[+-]digits],
+// start if none
+size_t ScanNumber(std::string_view str, size_t start) {
+    const size_t len = str.size();
+    size_t end = start;
+    if (end < len and (str[end] == '+' or str[end] == '-')) {
+        end++;
+    }
+    const size_t digit = end;
+    while (end < len and IsDigit(str[end])) {
+        end++;
+    }
+    if (end == digit) {
+        return start;
+    }
+    if (end < len and (str[end] == '.' or str[end] == ',')) {
+        end++;
+        while (end < len and IsDigit(str[end])) {
+            end++;
+        }
+    }
+    if (end < len and (str[end] == 'e' or str[end] == 'E')) {
+        size_t exp = end + 1;
+        if (exp < len and (str[exp] == '+' or str[exp] == '-')) {
+            exp++;
+        }
+        const size_t exp_digit = exp;
+        while (exp < len and IsDigit(str[exp])) {
+            exp++;
+        }
+        if (exp > exp_digit) {
+            end = exp;
+        }
+    }
+    return end;
+}
+
+// Parse a parameter line: key [number] [string], return false if the key is missing
+bool ParseLine(std::string_view str, LineFields& fields) {
+    const size_t len = str.size();
+    size_t pos = 0;
+    while (pos < len and IsWord(str[pos])) {
+        pos++;
+    }
+    if (pos == 0) {
+        return false;
+    }
+    fields = {str.substr(0, pos), {}, {}};
+
+    // numeric value, only after at least one space
+    size_t start = pos;
+    while (start < len and IsSpace(str[start])) {
+        start++;
+    }
+    if (start > pos) {
+        const size_t end = ScanNumber(str, start);
+        if (end > start) {
+            fields.Number = str.substr(start, end - start);
+            pos = end;
+        }
+    }
+
+    // string value, after at least one space, up to the end of the line
+    start = pos;
+    while (start < len and IsSpace(str[start])) {
+        start++;
+    }
+    // as the regex, give back spaces until a character matches '.'
+    for (; start > pos; start--) {
+        if (start < len and not IsLineEnd(str[start])) {
+            size_t end = start;
+            while (end < len and not IsLineEnd(str[end])) {
+                end++;
+            }
+            fields.Text = str.substr(start, end - start);
+            break;
+        }
+    }
+    return true;
+}
+
+// Find the name of a table in "=name=", empty if none
+std::string_view FindTableName(std::string_view str) {
+    for (size_t pos = str.find('='); pos != string::npos;
+         pos = str.find('=', pos + 1)) {
+        size_t end = pos + 1;
+        while (end < str.size() and IsWord(str[end])) {
+            end++;
+        }
+        if (end > pos + 1 and end < str.size() and str[end] == '=') {
+            return str.substr(pos + 1, end - pos - 1);
+        }
+    }
+    return {};
+}
+
+// Remove the leading "=name=" and the following spaces of a table header
+void StripTableName(std::string_view& header) {
+    if (header.empty() or header.front() != '=') {
+        return;
+    }
+    size_t end = 1;
+    while (end < header.size() and IsWord(header[end])) {
+        end++;
+    }
+    if (end == 1 or end == header.size() or header[end] != '=') {
+        return;
+    }
+    end++;
+    while (end < header.size() and IsSpace(header[end])) {
+        end++;
+    }
+    header.remove_prefix(end);
+}
+
+// Split on spaces: the leading token is kept even if empty, not the trailing one,
+// unless there is no space at all: the whole string is then the only token
+void SplitOnSpace(std::string_view str, vector<std::string_view>& tokens) {
+    tokens.clear();
+    size_t pos = 0;
+    for (size_t sep = 0; sep < str.size(); sep++) {
+        if (not IsSpace(str[sep])) {
+            continue;
+        }
+        tokens.push_back(str.substr(pos, sep - pos));
+        while (sep < str.size() and IsSpace(str[sep])) {
+            sep++;
+        }
+        pos = sep;
+    }
+    if (pos < str.size() or tokens.empty()) {
+        tokens.push_back(str.substr(pos));
+    }
+}
+
+/// Read a stream or a memory buffer line by line, without the '\n'. As with
+/// std::getline(...).good(), a last line without '\n' is not read.
+class LineReader {
+public:
+    explicit LineReader(std::istream& is): Stream(&is) {}
+    explicit LineReader(std::string_view buffer): Buffer(buffer) {}
+
+    // lines of a buffer are views on it, so that consecutive lines are contiguous
+    inline bool IsBuffer() const { return Stream == nullptr; }
+
+    // the line is valid until the next call
+    bool Next(std::string_view& line) {
+        if (Stream) {
+            if (not getline(*Stream, Line).good() or Stream->fail()) {
+                return false;
+            }
+            line = Line;
+            return true;
+        }
+        const size_t end = Buffer.find('\n');
+        if (end == string::npos) {
+            return false;
+        }
+        line = Buffer.substr(0, end);
+        Buffer.remove_prefix(end + 1);
+        return true;
+    }
+
+private:
+    std::istream* Stream = nullptr;
+    std::string_view Buffer;
+    std::string Line;
+};
+
+/// Read-only memory mapping of a whole file, empty if the file can not be mapped
+/// (not a regular file, empty file...)
+class MappedFile {
+public:
+    explicit MappedFile(const string& filename) {
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;  // not mapped, the stream reports the error
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 and S_ISREG(st.st_mode) and st.st_size > 0) {
+            void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                madvise(addr, st.st_size, MADV_SEQUENTIAL);
+                Data = static_cast<const char*>(addr);
+                Size = st.st_size;
+            }
+        }
+        close(fd);
+    }
+    ~MappedFile() {
+        if (Data) {
+            munmap(const_cast<char*>(Data), Size);
+        }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    inline bool IsMapped() const { return Data != nullptr; }
+    inline std::string_view View() const { return {Data, Size}; }
+
+private:
+    const char* Data = nullptr;
+    size_t Size = 0;
+};
+
+/// A parameter, a table or a badly formatted line read from a file
+struct Record {
+    enum EKind {
+        kParameter,
+        kTable,
+        kBadLine
+    };
+    Record(EKind kind, std::string key): Kind(kind), Key(std::move(key)) {}
+
+    EKind Kind;
+    std::string Key;  // or the whole line if badly formatted
+    std::string Text;
+    double Number = 0.;
+    bool HasNumber = false;
+    std::shared_ptr<DataTable> Table;  // null if it failed to be built
+};
+
+/** Storage of the keys of a database, each interned once: the characters are copied
+    in large blocks, never moved nor freed before the arena, so that the views on them
+    stay valid. An arena keeps alive the arena of the database it was copied from. */
+class KeyArena {
+public:
+    explicit KeyArena(std::shared_ptr<const KeyArena> parent = nullptr):
+        Parent(std::move(parent)) {}
+
+    std::string_view Intern(std::string_view key) {
+        if (key.size() > Free) {
+            const size_t size = std::max(kBlockSize, key.size());
+            Blocks.push_back(std::make_unique<char[]>(size));
+            Next = Blocks.back().get();
+            Free = size;
+        }
+        std::memcpy(Next, key.data(), key.size());
+        const std::string_view interned(Next, key.size());
+        Next += key.size();
+        Free -= key.size();
+        return interned;
+    }
+
+private:
+    static constexpr size_t kBlockSize = 1 << 16;
+
+    std::shared_ptr<const KeyArena> Parent;
+    vector<std::unique_ptr<char[]>> Blocks;
+    char* Next = nullptr;
+    size_t Free = 0;
+};
+
+/// Size of the blocks in which a text is written
+constexpr size_t kTextBlock = 1 << 20;
+
+/// Append a number as written by a stream of precision 15, "%.15g", in any locale
+void AppendNumber(string& buffer, double value) {
+    char digits[32];
+    const auto result = std::to_chars(
+        digits, digits + sizeof(digits), value, std::chars_format::general, 15);
+    buffer.append(digits, result.ptr);
+}
+
+/// The content of a file, parsed but not yet stored in the database
+struct Staging {
+    std::vector<Record> Records;  // in the order of the file
+    std::exception_ptr Error;  // error which stopped the parsing, if any
+    std::int64_t ModTime = -1;  // last modification of the file before parsing
+    std::vector<std::string> CacheWarnings;  // image of the file ignored or not written
+};
+
+/** Read a whole cell as a number with std::from_chars, whatever the locale. Beside
+    its formats (with "inf" and "nan"), the decimal separator may be a comma, and a
+    leading '+' or an hexadecimal number are accepted, as by std::stod. The
+    out-of-range numbers are rejected. */
+bool ToNumber(std::string_view cell, double& value) {
+    const char* end = cell.data() + cell.size();
+    const auto result = std::from_chars(cell.data(), end, value);
+    if (result.ec == std::errc() and result.ptr == end) {
+        return true;
+    }
+    if (result.ec == std::errc::result_out_of_range or cell.empty()) {
+        return false;
+    }
+
+    // the rare other formats, on a copy to change the decimal separator
+    string copy(cell);
+    const size_t comma = copy.find(',');
+    if (comma != string::npos) {
+        copy[comma] = '.';
+    }
+    const char* begin = copy.c_str();
+    end = begin + copy.size();
+    const bool negative = *begin == '-';
+    if (negative or *begin == '+') {
+        begin++;
+    }
+    auto format = std::chars_format::general;
+    if (end - begin > 2 and begin[0] == '0' and (begin[1] == 'x' or begin[1] == 'X')) {
+        begin += 2;
+        format = std::chars_format::hex;
+    }
+    if (begin == end or *begin == '+' or *begin == '-') {
+        return false;
+    }
+    const auto last = std::from_chars(begin, end, value, format);
+    if (last.ec != std::errc() or last.ptr != end) {
+        return false;
+    }
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+/// Slot of a hash in a table of mask+1 slots, mixed since the hash of an integer is
+/// the integer itself
+inline size_t SlotOf(hash_t hash, size_t mask) {
+    hash *= 0x9E3779B97F4A7C15ull;
+    return (hash ^ (hash >> 32)) & mask;
+}
+
+/// Hash table of the rows of a column, with linear probing: the slots hold row+1 of
+/// the first row of each value, 0 if empty, and are at least twice the rows
+template<typename Hash, typename Equal>
+vector<int> BuildSlots(int nbrow, Hash hash, Equal equal) {
+    size_t size = 2;
+    while (size < 2 * static_cast<size_t>(nbrow)) {
+        size *= 2;
+    }
+    vector<int> slots(size, 0);
+    for (int row = 0; row < nbrow; row++) {
+        size_t i = SlotOf(hash(row), size - 1);
+        while (slots[i] != 0 and not equal(slots[i] - 1, row)) {
+            i = (i + 1) & (size - 1);
+        }
+        if (slots[i] == 0) {
+            slots[i] = row + 1;
+        }
+    }
+    return slots;
+}
+
+/// The row found by its hash in the slots, -1 if none
+template<typename Equal>
+int FindSlot(const vector<int>& slots, hash_t hash, Equal equal) {
+    const size_t mask = slots.size() - 1;
+    for (size_t i = SlotOf(hash, mask); slots[i] != 0; i = (i + 1) & mask) {
+        if (equal(slots[i] - 1)) {
+            return slots[i] - 1;
+        }
+    }
+    return -1;
+}
+
+/// Binary image of records, see DataBase::WriteBinary: a header, then the records in
+/// order, a string being its size then its characters, in the native byte order
+struct ImageHeader {
+    char Magic[8];
+    std::uint32_t Format;  // version of the layout of the records
+    std::uint32_t ByteOrder;  // kByteOrder as written, to detect a foreign image
+    std::uint64_t NbRecords;
+    std::uint64_t Size;  // of the records following the header
+    std::uint64_t Checksum;  // of the records, see below
+};
+constexpr char kImageMagic[8] = "ToolsDB";
+constexpr std::uint32_t kImageFormat = 2;
+constexpr std::uint32_t kByteOrder = 0x01020304;
+
+/// FNV-1a on 8 bytes words instead of bytes, to check a large image at memory speed,
+/// with a rotation so that the high bits of a word also reach the low bits of the sum
+std::uint64_t Checksum(std::string_view data) {
+    hash_t sum = detail_string::basis;
+    size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= data.size(); i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, data.data() + i, sizeof(std::uint64_t));
+        sum ^= word;
+        sum = ((sum << 29) | (sum >> 35)) * detail_string::prime;
+    }
+    for (; i < data.size(); i++) {
+        sum = (sum ^ static_cast<unsigned char>(data[i])) * detail_string::prime;
+    }
+    return sum;
+}
+
+/// Build an image in a single buffer
+class ImageWriter {
+public:
+    ImageWriter() { Buffer.resize(sizeof(ImageHeader)); }
+
+    void Parameter(
+        std::string_view key, bool has_number, double number, std::string_view text) {
+        Put<std::uint8_t>(Record::kParameter);
+        PutString(key);
+        Put<std::uint8_t>(has_number);
+        Put(number);
+        PutString(text);
+        NbRecords++;
+    }
+    void Table(std::string_view name, const DataTable& table) {
+        Put<std::uint8_t>(Record::kTable);
+        PutString(name);
+        const vector<string>& ColNames = table.GetColumnNames();
+        Put<std::uint32_t>(ColNames.size());
+        Put<std::uint32_t>(table.GetNbRows());
+        for (const string& colname : ColNames) {
+            PutString(colname);
+            for (const string& cell : table.GetColumn(colname)) {
+                PutString(cell);
+            }
+            // the typed arrays, so that the types are not inferred again
+            const DataTable::EType type = table.GetColumnType(colname);
+            Put<std::uint8_t>(type);
+            if (type != DataTable::kString) {
+                PutArray(table.GetNumColumn(colname));
+            }
+            if (type == DataTable::kInt) {
+                PutArray(table.GetIntColumn(colname));
+            }
+        }
+        NbRecords++;
+    }
+    void Add(const Record& record) {
+        if (record.Kind == Record::kParameter) {
+            Parameter(record.Key, record.HasNumber, record.Number, record.Text);
+        } else if (record.Kind == Record::kTable) {
+            Table(record.Key, *record.Table);
+        } else {
+            Put<std::uint8_t>(Record::kBadLine);
+            PutString(record.Key);
+            NbRecords++;
+        }
+    }
+
+    // complete the header, then the buffer is the image
+    const string& Finish() {
+        ImageHeader header;
+        std::copy(std::begin(kImageMagic), std::end(kImageMagic), header.Magic);
+        header.Format = kImageFormat;
+        header.ByteOrder = kByteOrder;
+        header.NbRecords = NbRecords;
+        header.Size = Buffer.size() - sizeof(ImageHeader);
+        header.Checksum =
+            Checksum(std::string_view(Buffer).substr(sizeof(ImageHeader)));
+        std::memcpy(Buffer.data(), &header, sizeof(ImageHeader));
+        return Buffer;
+    }
+
+private:
+    template<typename T>
+    inline void Put(T value) {
+        Buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    inline void PutString(std::string_view str) {
+        Put<std::uint32_t>(str.size());
+        Buffer.append(str);
+    }
+    template<typename T>
+    inline void PutArray(DataTable::View<T> array) {
+        Buffer.append(
+            reinterpret_cast<const char*>(array.data()), array.size() * sizeof(T));
+    }
+
+    string Buffer;
+    std::uint64_t NbRecords = 0;
+};
+
+/// Read an image in place, checking the header and every size against the end
+class ImageReader {
+public:
+    explicit ImageReader(std::string_view image) {
+        ImageHeader header;
+        if (image.size() < sizeof(ImageHeader)) {
+            throw DataBaseError(" ***Error DataBase::ReadBinary: Not a binary image");
+        }
+        std::memcpy(&header, image.data(), sizeof(ImageHeader));
+        if (not std::equal(
+                std::begin(kImageMagic), std::end(kImageMagic), header.Magic)) {
+            throw DataBaseError(" ***Error DataBase::ReadBinary: Not a binary image");
+        }
+        if (header.Format != kImageFormat or header.ByteOrder != kByteOrder) {
+            throw DataBaseError(
+                " ***Error DataBase::ReadBinary: Unsupported format or byte order");
+        }
+        Data = image.substr(sizeof(ImageHeader));
+        if (Data.size() != header.Size or Checksum(Data) != header.Checksum) {
+            throw DataBaseError(" ***Error DataBase::ReadBinary: Corrupted image");
+        }
+        // the smallest record is a bad line: its kind and the size of its string
+        NbRecords = header.NbRecords;
+        CheckCount(NbRecords, sizeof(std::uint8_t) + sizeof(std::uint32_t));
+    }
+
+    inline std::uint64_t GetNbRecords() const { return NbRecords; }
+
+    /// Check that count items of at least min_size bytes each fit in the rest of
+    /// the image, before trusting the count to allocate memory
+    inline void CheckCount(std::uint64_t count, size_t min_size) const {
+        if (count > (Data.size() - Pos) / min_size) {
+            throw DataBaseError(" ***Error DataBase::ReadBinary: Corrupted image");
+        }
+    }
+
+    template<typename T>
+    inline T Get() {
+        Check(sizeof(T));
+        T value;
+        std::memcpy(&value, Data.data() + Pos, sizeof(T));
+        Pos += sizeof(T);
+        return value;
+    }
+    inline std::string_view GetString() {
+        const std::uint32_t size = Get<std::uint32_t>();
+        Check(size);
+        Pos += size;
+        return Data.substr(Pos - size, size);
+    }
+    template<typename T>
+    inline void GetArray(std::vector<T>& array, size_t size) {
+        Check(size * sizeof(T));
+        array.resize(size);
+        std::memcpy(array.data(), Data.data() + Pos, size * sizeof(T));
+        Pos += size * sizeof(T);
+    }
+
+private:
+    inline void Check(size_t size) const {
+        if (size > Data.size() - Pos) {
+            throw DataBaseError(" ***Error DataBase::ReadBinary: Truncated image");
+        }
+    }
+
+    std::string_view Data;
+    size_t Pos = 0;
+    std::uint64_t NbRecords = 0;
+};
+
+/// Write an image through a temporary file renamed at the end, so that a concurrent
+/// reader never sees a partial image
+void WriteImageFile(const string& filename, const string& image) {
+    const string tmpname = cat(filename, ".tmp", getpid());
+    ofstream ofs(tmpname, std::ios::out | std::ios::binary);
+    ofs.write(image.data(), image.size());
+    ofs.close();
+    if (not ofs or std::rename(tmpname.c_str(), filename.c_str()) != 0) {
+        std::remove(tmpname.c_str());
+        throw DataBaseError(
+            " ***Error DataBase::WriteBinary: Could not write ", filename);
+    }
+}
+
+/// Last modification time of a file, in ns, -1 if it can not be accessed
+std::int64_t GetModTime(const string& filename) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) {
+        return -1;
+    }
+    return std::int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+/// Number of threads left to the loops of a task of ParallelFor, its share of the
+/// threads of the pool running it, 0 out of any ParallelFor
+thread_local unsigned theThreadShare = 0;
+
+/// Number of threads for a loop asking for nb_threads, 0 for all: within the share
+/// of the enclosing ParallelFor if any, so that nested loops do not oversubscribe
+unsigned GetNbThreads(unsigned nb_threads) {
+    if (theThreadShare != 0) {
+        return nb_threads == 0 ? theThreadShare : std::min(nb_threads, theThreadShare);
+    }
+    return nb_threads == 0 ? std::max(1U, std::thread::hardware_concurrency())
+                           : nb_threads;
+}
+
+/// Run task(i) for i in [0, size) on a pool of threads, 0 for the hardware threads
+/// or the share of the enclosing ParallelFor, see GetNbThreads. The threads of the
+/// pool are shared between its threads for the loops of the tasks.
+/// The task must not throw.
+void ParallelFor(
+    size_t size, unsigned nb_threads, const std::function<void(size_t)>& task) {
+    nb_threads = GetNbThreads(nb_threads);
+    const unsigned nb_pool = std::max<size_t>(1, std::min<size_t>(nb_threads, size));
+    const unsigned share = nb_threads / nb_pool;
+    std::atomic<size_t> next(0);
+    auto run = [&]() {
+        theThreadShare = share;
+        for (size_t i = next++; i < size; i = next++) {
+            task(i);
+        }
+    };
+
+    vector<std::thread> pool;
+    for (unsigned i = 1; i < nb_pool; i++) {
+        pool.emplace_back(run);
+    }
+    const unsigned outer_share = theThreadShare;
+    run();
+    theThreadShare = outer_share;
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+/// Call read(reader) on the lines of a file, in place if it is memory mapped, else
+/// through a stream. Return false if the file can not be opened.
+template<typename Read>
+bool ReadLines(const string& FileWithPath, DataBase::ELoading loading, Read read) {
+    if (loading == DataBase::kMemoryMap) {
+        MappedFile file(FileWithPath);
+        if (file.IsMapped()) {
+            LineReader reader(file.View());
+            read(reader);
+            return true;
+        }
+    }
+
+    ifstream ifs;
+    ifs.open(FileWithPath, std::ios::in);
+    if (! ifs.is_open() || ! ifs.good()) {
+        return false;
+    }
+    LineReader reader(ifs);
+    read(reader);
+    return true;
+}
+
+/** Parse a table, from its header line to the first blank line: names(tokens) is
+    called once with the column names, then row(cells) on each row. The names and
+    cells are views valid until the next call. Throw on a row of bad size, with the
+    caller in the message. */
+template<typename Names, typename Row>
+void ParseTable(
+    LineReader& reader,
+    std::string_view header,
+    DataBase::EParser parser,
+    const char* caller,
+    Names names,
+    Row row) {
+    string str;
+    std::string_view line;
+    vector<std::string_view> tokens;
+
+    // the legacy engine, only built if requested
+    std::unique_ptr<Regex> regSharp, regSpace, regComment;
+    if (parser == DataBase::kRegex) {
+        regSharp = std::make_unique<Regex>("#");
+        regSpace = std::make_unique<Regex>("\\s+");
+        regComment = std::make_unique<Regex>("\\s*#.*$");
+    }
+    // split the line on spaces, with the selected engine
+    auto split = [&](std::string_view view) {
+        if (parser == DataBase::kRegex) {
+            const vector<string>& split_tokens = regSpace->Split(string(view));
+            tokens.assign(split_tokens.begin(), split_tokens.end());
+        } else {
+            SplitOnSpace(view, tokens);
+        }
+    };
+    // remove the comment at the end of the line, if any
+    auto strip = [&](std::string_view& view) {
+        if (parser == DataBase::kRegex) {
+            str = string(view);
+            while (regSharp->Match(str)) {
+                regComment->Substitute(str, "");
+            }
+            view = str;
+        } else {
+            StripComment(view);
+        }
+    };
+
+    // parse header line
+    // remove '=tablename=' and possible spaces
+    if (parser == DataBase::kRegex) {
+        str = header;
+        Regex("^=\\w+=\\s*").Substitute(str, "");
+        header = str;
+    } else {
+        StripTableName(header);
+    }
+    // check if a comment is a the end of the line
+    strip(header);
+
+    // split the string on spaces
+    split(header);
+    const size_t NbCol = tokens.size();
+    names(tokens);
+
+    // process the data lines
+    int NbRow = 0;
+    while (reader.Next(line)) {
+        // skip lines beginning with '#'
+        if (not line.empty() and line.front() == '#') {
+            continue;
+        }
+        strip(line);  // remove if necessary
+
+        // end of the table at the first blank line
+        if (line.empty() || line.find_first_not_of(' ') == string::npos) {
+            break;
+        }
+
+        // parse the line
+        split(line);
+        if (tokens.size() - 1 != NbCol) {
+            throw DataBaseError(
+                " ***Error ",
+                caller,
+                ": Bad line, expected ",
+                NbCol,
+                " columns, got ",
+                tokens.size(),
+                " values on row ",
+                NbRow);
+        }
+
+        // all is well, the first token is the empty one before the leading space
+        row(tokens.data() + 1);
+        NbRow++;
+    }
+}
+
+/// Number of cells of a table above which the types are set concurrently
+constexpr size_t kParallelCells = 1 << 18;
+
+/** The lines of the body of a table, up to its first blank line, the reader being
+    left after it as by ParseTable: in place in a buffer, else copied in storage. */
+std::string_view ReadTableBody(LineReader& reader, string& storage) {
+    std::string_view line;
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    while (reader.Next(line)) {
+        if (line.empty() or line.front() != '#') {
+            std::string_view view = line;
+            StripComment(view);
+            if (view.empty() || view.find_first_not_of(' ') == string::npos) {
+                break;
+            }
+        }
+        if (reader.IsBuffer()) {
+            begin = begin ? begin : line.data();
+            end = line.data() + line.size() + 1;  // with the '\n'
+        } else {
+            storage.append(line).push_back('\n');
+        }
+    }
+    return reader.IsBuffer() ? std::string_view(begin, end - begin) : storage;
+}
+
+/// The columns parsed from a chunk of the body of a table, as by ParseTable
+struct TableChunk {
+    std::string_view Lines;
+    vector<vector<string>> Columns;
+    int NbRow = 0;
+    size_t BadSize = 0;  // number of values on the first bad row, 0 if none
+};
+
+/// Split the body of a table in chunks of whole lines, at least chunk_size bytes
+/// long, one per available thread at most, see GetNbThreads
+vector<TableChunk> SplitInChunks(std::string_view body, size_t chunk_size) {
+    const size_t nb_threads = GetNbThreads(0);
+    const size_t nb_chunks = std::min(body.size() / chunk_size + 1, nb_threads);
+    vector<TableChunk> chunks(nb_chunks);
+    for (size_t i = 0; i < nb_chunks; i++) {
+        size_t size = body.size();
+        if (i + 1 < nb_chunks) {  // an equal share of the rest, up to the end of line
+            size = std::min(body.find('\n', size / (nb_chunks - i)), size - 1) + 1;
+        }
+        chunks[i].Lines = body.substr(0, size);
+        body.remove_prefix(size);
+    }
+    return chunks;
+}
+
+/// Parse the rows of a chunk with the tokenizer, up to the first bad row, in the
+/// given columns
+void ParseChunk(TableChunk& chunk, const vector<vector<string>*>& columns) {
+    LineReader reader(chunk.Lines);
+    std::string_view line;
+    vector<std::string_view> tokens;
+    const size_t nb_col = columns.size();
+    const size_t nb_lines = std::count(chunk.Lines.begin(), chunk.Lines.end(), '\n');
+    for (auto column : columns) {
+        column->reserve(column->size() + nb_lines);
+    }
+    while (reader.Next(line)) {
+        if (not line.empty() and line.front() == '#') {
+            continue;
+        }
+        StripComment(line);
+        SplitOnSpace(line, tokens);
+        if (tokens.size() - 1 != nb_col) {
+            chunk.BadSize = tokens.size();
+            return;
+        }
+        for (size_t i = 0; i < nb_col; i++) {
+            columns[i]->emplace_back(tokens[i + 1]);
+        }
+        chunk.NbRow++;
+    }
+}
+}  // namespace detail_database
+
 ////////////////////////////////////////////////////////////////
 /** ReadFile: read a file.  See class documentation for file format.
     If a parameter is defined more than once, e.g., due to calling ReadFile
@@ -75,174 +1039,684 @@ void DataBase::ReadFile(istream& is, string prefix, DataBase::EOverwrite overwri
         throw DataBaseError(" ***Error DataBase::ReadFile1: Read-only database");
     }
 
+    detail_database::LineReader reader(is);
+    detail_database::Staging staging;
+    ParseLines(reader, prefix, staging);
+    Diags = Diagnostics();
+    Store(staging, overwrite);
+    Report();
+}
+
+////////////////////////////////////////////////////////////////
+/// ReadFile: read from a file of the given name.
+void DataBase::ReadFile(
+    const char* filename,
+    const char* env_path,
+    const char* prefix,
+    DataBase::EOverwrite overwrite) {
+    string FileWithPath = filename;
+    if (env_path) {
+        FileWithPath = GetPath(env_path) + FileWithPath;
+    }
+
+    if (IsReadOnly) {
+        throw DataBaseError(
+            " ***Error DataBase::ReadFile2: Read-only database, can not update: ",
+            FileWithPath);
+    }
+
+    detail_database::Staging staging;
+    ParseFile(FileWithPath, prefix ? prefix : "", staging);
+    Diags = Diagnostics();
+    Store(staging, overwrite);
+    Sources.push_back({FileWithPath, prefix ? prefix : "", overwrite, staging.ModTime});
+    Report();
+}
+
+////////////////////////////////////////////////////////////////
+/** ReadBinary: read a binary image written by WriteBinary, as ReadFile would read
+    the equivalent text file. The image is memory mapped and checked before anything
+    is stored. The files read this way are not read again by Reload.
+    @param  filename   name of the image file
+    @param  env_path   environment variable holding the path to the file, if any
+    @param  prefix     prefix prepended (with a dot) to all the parameters of the image
+    @param  overwrite  indicates how to handle parameter redefinitions
+ */
+void DataBase::ReadBinary(
+    const char* filename,
+    const char* env_path,
+    const char* prefix,
+    DataBase::EOverwrite overwrite) {
+    string FileWithPath = filename;
+    if (env_path) {
+        FileWithPath = GetPath(env_path) + FileWithPath;
+    }
+
+    if (IsReadOnly) {
+        throw DataBaseError(
+            " ***Error DataBase::ReadBinary: Read-only database, can not update: ",
+            FileWithPath);
+    }
+
+    detail_database::Staging staging;
+    {
+        detail_database::MappedFile image(FileWithPath);
+        if (not image.IsMapped()) {
+            throw DataBaseError(
+                " ***Error DataBase::ReadBinary: Could not map: ", FileWithPath);
+        }
+        ParseImage(image.View(), prefix ? prefix : "", staging);
+    }
+    Diags = Diagnostics();
+    Store(staging, overwrite);
+    Report();
+}
+
+////////////////////////////////////////////////////////////////
+/** ReadFiles: read several files concurrently, with the same result as successive
+    calls to ReadFile in the order of the list: each file is parsed by a thread in its
+    own staging area, then the staging areas are stored one after the other.
+    @param  files       the files to read, as the arguments of ReadFile
+    @param  overwrite   indicates how to handle parameter redefinitions
+    @param  nb_threads  number of threads, 0 for the number of hardware threads
+ */
+void DataBase::ReadFiles(
+    const std::vector<InputFile>& files,
+    DataBase::EOverwrite overwrite,
+    unsigned nb_threads) {
+    if (IsReadOnly) {
+        throw DataBaseError(" ***Error DataBase::ReadFiles: Read-only database");
+    }
+
+    vector<detail_database::Staging> stagings(files.size());
+    vector<string> paths(files.size());
+    detail_database::ParallelFor(files.size(), nb_threads, [&](size_t i) {
+        const InputFile& file = files[i];
+        try {
+            paths[i] = file.filename;
+            if (not file.env_path.empty()) {
+                paths[i] = GetPath(file.env_path) + paths[i];
+            }
+            ParseFile(paths[i], file.prefix, stagings[i]);
+        } catch (...) {
+            stagings[i].Error = std::current_exception();
+        }
+    });
+
+    // store in the order of the list, as if the files were read one by one
+    Diags = Diagnostics();
+    for (size_t i = 0; i < files.size(); i++) {
+        Store(stagings[i], overwrite);
+        Sources.push_back({paths[i], files[i].prefix, overwrite, stagings[i].ModTime});
+    }
+    Report();
+}
+
+////////////////////////////////////////////////////////////////
+/** StreamTable: parse a table of a file and call back on each row, in order, as the
+    lines are read. Only the current line is held: the file is read through a stream
+    with SetLoading(kStream), else in place from the mapped file, whose pages are
+    released by the system as needed. The reading stops at the end of the table.
+    @param  filename   name of the file
+    @param  tablename  name of the table, as in '=tablename='
+    @param  callback   called on each row, which is only valid during the call
+    @param  env_path   environment variable holding the path to the file, if any
+ */
+void DataBase::StreamTable(
+    const char* filename,
+    std::string_view tablename,
+    const std::function<void(const TableRow&)>& callback,
+    const char* env_path) const {
+    string FileWithPath = filename;
+    if (env_path) {
+        FileWithPath = GetPath(env_path) + FileWithPath;
+    }
+
+    bool found = false;
+    auto stream = [&](detail_database::LineReader& reader) {
+        std::string_view line;
+        while (not found and reader.Next(line)) {
+            if (line.empty() or line.front() != '='
+                or detail_database::FindTableName(line) != tablename) {
+                continue;
+            }
+            found = true;
+            TableRow row;
+            detail_database::ParseTable(
+                reader,
+                line,
+                Parser,
+                "DataBase::StreamTable",
+                [&row](const vector<std::string_view>& names) {
+                    row.ColNames.assign(names.begin(), names.end());
+                },
+                [&row, &callback](const std::string_view* cells) {
+                    row.Cells = cells;
+                    callback(row);
+                    row.Row++;
+                });
+        }
+    };
+    if (not detail_database::ReadLines(FileWithPath, Loading, stream)) {
+        throw DataBaseError(
+            " ***Error DataBase::StreamTable: Could not open: ", FileWithPath);
+    }
+    if (not found) {
+        throw DataBaseError(
+            " ***Error DataBase::StreamTable: No table ",
+            tablename,
+            " in ",
+            FileWithPath);
+    }
+}
+
+////////////////////////////////////////////////////////////////
+/** Reload: build a new version of the published database, by reading again the
+    files in the order, with the prefix and the overwrite policy, of their first
+    reading. The readers are not blocked: the new version is published at once when
+    complete, and nothing is published if an error occurs. The values which were not
+    read from a file, by ReadFile from a stream or set directly, are not kept.
+    A version published by Publish during the reload is not replaced: the reload
+    starts again from it.
+    @param  reload      kIfModified to reload only if a file was modified
+    @param  nb_threads  number of threads, 0 for the number of hardware threads
+    @return true if a new version was published
+ */
+bool DataBase::Reload(DataBase::EReload reload, unsigned nb_threads) {
+    std::lock_guard<std::mutex> reload_lock(theReloadMutex);
+    shared_ptr<const DataBase> current;
+    {
+        std::lock_guard<std::mutex> lock(theMutex);
+        current = theSnapshot;
+    }
+    if (not current) {
+        throw DataBaseError(" ***Error DataBase::Reload: No published database");
+    }
+
+    // built again from the new version if one was published meanwhile by Publish,
+    // which would be lost otherwise
+    for (;;) {
+        if (reload == kIfModified and not current->IsModified()) {
+            return false;
+        }
+
+        std::unique_ptr<DataBase> next(new DataBase(false));
+        next->Parser = current->Parser;
+        next->Loading = current->Loading;
+        next->ChunkSize = current->ChunkSize;
+        next->Cache = current->Cache;
+        next->Verbosity = current->Verbosity;
+        const vector<Source>& sources = current->Sources;
+        vector<detail_database::Staging> stagings(sources.size());
+        detail_database::ParallelFor(sources.size(), nb_threads, [&](size_t i) {
+            next->ParseFile(sources[i].FileWithPath, sources[i].Prefix, stagings[i]);
+        });
+        for (size_t i = 0; i < sources.size(); i++) {
+            next->Store(stagings[i], sources[i].Overwrite);
+            next->Sources.push_back(sources[i]);
+            next->Sources.back().ModTime = stagings[i].ModTime;
+        }
+        next->Report();
+
+        std::lock_guard<std::mutex> lock(theMutex);
+        if (theSnapshot == current) {
+            PublishLocked(next.release());
+            return true;
+        }
+        current = theSnapshot;
+    }
+}
+
+////////////////////////////////////////////////////////////////
+bool DataBase::IsModified() const {
+    for (const Source& source : Sources) {
+        if (detail_database::GetModTime(source.FileWithPath) != source.ModTime) {
+            return true;
+        }
+    }
+    return false;
+}
+
+////////////////////////////////////////////////////////////////
+/// ParseFile: parse a file, or its binary image, in the staging area, never throw
+void DataBase::ParseFile(
+    const string& FileWithPath,
+    const string& prefix,
+    detail_database::Staging& staging) const {
+#ifdef DEBUG
+    cout << " Attempting to read database from file " << FileWithPath << endl;
+#endif
+
+    // before the reading, so that a modification during it is seen by IsModified
+    staging.ModTime = detail_database::GetModTime(FileWithPath);
+    try {
+        if (Cache == kNoCache or staging.ModTime < 0) {
+            ParseText(FileWithPath, prefix, staging);
+            return;
+        }
+
+        const string CacheFile = FileWithPath + ".bin";
+        if (detail_database::GetModTime(CacheFile) > staging.ModTime) {
+            try {
+                detail_database::MappedFile image(CacheFile);
+                ParseImage(image.View(), prefix, staging);
+                return;
+            } catch (const std::exception& error) {
+                staging.CacheWarnings.push_back(
+                    cat("Ignoring binary image ", CacheFile, ": ", error.what()));
+                staging.Records.clear();
+            }
+        }
+        if (Cache == kUseCache) {
+            ParseText(FileWithPath, prefix, staging);
+            return;
+        }
+
+        // the image is written without the prefix, added afterwards
+        ParseText(FileWithPath, "", staging);
+        if (not staging.Error) {
+            detail_database::ImageWriter writer;
+            for (const detail_database::Record& record : staging.Records) {
+                writer.Add(record);
+            }
+            try {
+                detail_database::WriteImageFile(CacheFile, writer.Finish());
+            } catch (const std::exception& error) {
+                staging.CacheWarnings.push_back(error.what());
+            }
+        }
+        if (not prefix.empty()) {
+            for (detail_database::Record& record : staging.Records) {
+                if (record.Kind == detail_database::Record::kParameter) {
+                    record.Key = cat(prefix, ".", record.Key);
+                }
+            }
+        }
+    } catch (...) {
+        staging.Error = std::current_exception();
+    }
+}
+
+////////////////////////////////////////////////////////////////
+/// ParseText: parse the text of a file in the staging area
+void DataBase::ParseText(
+    const string& FileWithPath,
+    const string& prefix,
+    detail_database::Staging& staging) const {
+    auto parse = [&](detail_database::LineReader& reader) {
+        ParseLines(reader, prefix, staging);
+    };
+    if (not detail_database::ReadLines(FileWithPath, Loading, parse)) {
+        throw DataBaseError(
+            " ***Error DataBase::ReadFile3: Could not open: ", FileWithPath);
+    }
+}
+
+////////////////////////////////////////////////////////////////
+/** ParseImage: read the records of a binary image in the staging area, with the
+    prefix added to the parameters as by ParseLines. Throw if the image is invalid.
+ */
+void DataBase::ParseImage(
+    std::string_view image,
+    const string& prefix,
+    detail_database::Staging& staging) const {
+    using detail_database::Record;
+
+    detail_database::ImageReader reader(image);
+    const string dotted = prefix.empty() ? prefix : prefix + ".";
+    vector<Record>& records = staging.Records;
+    records.reserve(records.size() + reader.GetNbRecords());
+    for (std::uint64_t i = 0; i < reader.GetNbRecords(); i++) {
+        const auto kind = static_cast<Record::EKind>(reader.Get<std::uint8_t>());
+        if (kind == Record::kParameter) {
+            records.emplace_back(Record::kParameter, dotted);
+            Record& record = records.back();
+            record.Key += reader.GetString();
+            record.HasNumber = reader.Get<std::uint8_t>();
+            record.Number = reader.Get<double>();
+            record.Text = reader.GetString();
+        } else if (kind == Record::kTable) {
+            records.emplace_back(Record::kTable, string(reader.GetString()));
+            const std::uint32_t NbCol = reader.Get<std::uint32_t>();
+            const std::uint32_t NbRow = reader.Get<std::uint32_t>();
+            // a column holds at least its name, its type and the size of each cell
+            reader.CheckCount(NbCol, sizeof(std::uint32_t) + sizeof(std::uint8_t));
+            if (NbCol > 0) {
+                reader.CheckCount(NbRow, NbCol * sizeof(std::uint32_t));
+            }
+            vector<string> ColNames(NbCol);
+            vector<DataTable::Column> columns(NbCol);
+            for (std::uint32_t col = 0; col < NbCol; col++) {
+                ColNames[col] = reader.GetString();
+                DataTable::Column& column = columns[col];
+                column.Str.reserve(NbRow);
+                for (std::uint32_t row = 0; row < NbRow; row++) {
+                    column.Str.emplace_back(reader.GetString());
+                }
+                const std::uint8_t type = reader.Get<std::uint8_t>();
+                if (type > DataTable::kString) {
+                    throw DataBaseError(
+                        " ***Error DataBase::ReadBinary: Corrupted image");
+                }
+                column.Type = static_cast<DataTable::EType>(type);
+                if (column.Type != DataTable::kString) {
+                    reader.GetArray(column.Num, NbRow);
+                }
+                if (column.Type == DataTable::kInt) {
+                    reader.GetArray(column.Int, NbRow);
+                }
+            }
+            records.back().Table = shared_ptr<DataTable>(
+                new DataTable(std::move(ColNames), std::move(columns), NbRow));
+        } else if (kind == Record::kBadLine) {
+            records.emplace_back(Record::kBadLine, string(reader.GetString()));
+        } else {
+            throw DataBaseError(" ***Error DataBase::ReadBinary: Corrupted image");
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////
+/** ParseLines: the actual parsing of the lines, whatever their origin, in the
+    staging area. Does not modify the database, so it can be called concurrently.
+    Never throw: an error is saved in the staging area, after the records parsed
+    before it, and rethrown by Store.
+ */
+void DataBase::ParseLines(
+    detail_database::LineReader& reader,
+    string prefix,
+    detail_database::Staging& staging) const {
+    using detail_database::Record;
+
     if (not prefix.empty()) {
         prefix += ".";
     }
 
-    int NbMatch = 0, n = 0;
-    string str, key;
-
-    const string number("([+-]?\\d+(\\.\\d*)?([eE][+-]?\\d+)?)");
-    Regex regNum(number);
-    Regex regTable("^=");
-    Regex regComment("\\s*#.*$");
-    Regex regParse(cat("^(\\w+)(\\s+", number, ")?(\\s+(.+))?"));  // to parse the line
-    while (getline(is, str).good()) {  // get a line from the file
-        if (is.fail()) {
-            break;
-        }
+    string str;
+    std::string_view line;
+    detail_database::LineFields fields;
+    vector<Record>& records = staging.Records;
+
+    try {
+        // the legacy engine, only built if requested
+        std::unique_ptr<Regex> regComment, regName, regParse;
+        if (Parser == kRegex) {
+            const string number("([+-]?\\d+([.,]\\d*)?([eE][+-]?\\d+)?)");
+            regComment = std::make_unique<Regex>("\\s*#.*$");
+            regName = std::make_unique<Regex>("=(\\w+)=");
+            regParse = std::make_unique<Regex>(
+                cat("^(\\w+)(\\s+", number, ")?(\\s+(.+))?"));  // to parse the line
+        }
+
+        while (reader.Next(line)) {  // get a line from the file
+            // skip blank lines and lines beginning with '#'
+            if (line.empty() || line.front() == '#'
+                || line.find_first_not_of(' ') == string::npos) {
+                continue;
+            }
+            if (Parser == kRegex) {
+                str = line;
+                while (regComment->Match(str)) {
+                    regComment->Substitute(str, "");
+                }
+                line = str;
+            } else {
+                detail_database::StripComment(line);
+            }
+            // check if a comment is a the end of the line
+            if (line.empty()) {
+                continue;
+            }
+
+            // look for a table
+            if (line.front() == '=') {
+                // Get the table name
+                string tablename;
+                if (Parser == kRegex) {
+                    if (regName->Match(str)) {
+                        tablename = regName->at(1);
+                    }
+                } else {
+                    tablename = detail_database::FindTableName(line);
+                }
+                if (tablename.empty()) {
+                    throw DataBaseError(
+                        " ***Error DataBase::ReadFile2: Can not find table name in "
+                        "line: ",
+                        line);
+                }
+
+                // saved before being built, to check first if it is already defined
+                records.emplace_back(Record::kTable, tablename);
+                //    Here using make_shared is not possible because the constructor
+                //    of DataTable is private
+                records.back().Table = shared_ptr<DataTable>(
+                    new DataTable(reader, line, Parser, ChunkSize));
+                continue;
+            }
+
+            // no table, parse the string
+            bool parsed = false;
+            if (Parser == kRegex) {
+                const int NbMatch = regParse->Match(str);
+                parsed = NbMatch >= 2;
+                if (parsed) {
+                    fields.Key = regParse->at(1);
+                    fields.Number = NbMatch > 3 ? regParse->at(3) : std::string_view();
+                    fields.Text = NbMatch > 7 ? regParse->at(7) : std::string_view();
+                }
+            } else {
+                parsed = detail_database::ParseLine(line, fields);
+            }
+            if (not parsed) {  // nothing was found => error
+                records.emplace_back(Record::kBadLine, string(line));
+                continue;
+            }
+
+            records.emplace_back(Record::kParameter, prefix);
+            Record& record = records.back();
+            record.Key += fields.Key;
+            record.Text = fields.Text;
+            if (not fields.Number.empty()) {
+                record.HasNumber = true;
+                if (not detail_database::ToNumber(fields.Number, record.Number)) {
+                    throw DataBaseError(
+                        " ***Error DataBase::ReadFile2: Number out of range in line: ",
+                        line);
+                }
+            }
+        }
+    } catch (...) {
+        staging.Error = std::current_exception();
+    }
+}
+
+////////////////////////////////////////////////////////////////
+/// Store: save the content of a staging area in the database, then throw its error
+void DataBase::Store(
+    detail_database::Staging& staging, DataBase::EOverwrite overwrite) {
+    using detail_database::Record;
 
-        // skip blank lines and lines beginning with '#'
-        if (str.empty() || str.front() == '#'
-            || str.find_first_not_of(' ') == string::npos) {
-            continue;
-        }
-        while (regComment.Match(str)) {
-            regComment.Substitute(str, "");
-        }
-        // check if a comment is a the end of the line
-        if (str.empty()) {
+    for (const string& warning : staging.CacheWarnings) {
+        Warn(kCache, warning);
+    }
+    int n = 0;
+    for (Record& record : staging.Records) {
+        const string& key = record.Key;
+        const hash_t hash = strhash(key);
+        if (record.Kind == Record::kBadLine) {
+            Warn(kBadLine, key);
             continue;
         }
 
-        // look for a table
-        if (regTable.Match(str)) {
-            // Get the table name
-            Regex regName("=(\\w+)=");
-            if (not regName.Match(str)) {
-                throw DataBaseError(
-                    " ***Error DataBase::ReadFile2: Can not find table name in line: ",
-                    str);
-            }
-            const string tablename = regName.at(1);
-
-            if (TableMap.count(tablename) != 0) {
+        Entry* entry = Find(key, hash);
+        if (record.Kind == Record::kTable) {
+            if (entry and entry->Table) {
                 throw DataBaseError(
                     " ***Error DataBase::ReadFile3: Attempt to redefine already "
                     "defined table: ",
-                    tablename);
+                    key);
             }
-
-            //       TableMap[tablename] = make_shared<DataTable>(is,str);
-            //    Here using make_shared is not possible because the constructor of
-            //    DataTable is private
-            TableMap[tablename] = shared_ptr<DataTable>(new DataTable(is, str));
-            StringMap[tablename] = tablename;
-            NumMap[tablename] = TableMap[tablename]->GetNbRows();
-            KeyList.push_back(tablename);
-            continue;
-        }
-
-        // no table, parse the string
-        NbMatch = regParse.Match(str);
-        if (NbMatch < 2) {  // nothing was found => error
-            cerr << " *Warning DataBase::ReadFile1: Bad format of line " << str
-                 << "\nSkipping...\n";
+            if (not record.Table) {  // failed to be built, see the error
+                break;
+            }
+            if (not entry) {
+                entry = &Insert(Intern(key), hash);
+            }
+            entry->Table = record.Table;
+            entry->HasStr = true;
+            entry->Str = key;
+            entry->HasNum = true;
+            entry->Num = record.Table->GetNbRows();
+            KeyList.push_back(entry->Key);
             continue;
         }
-        key = prefix + regParse.at(1);
 
         // Now save value(s).  By convention, any defined parameter will
         // always have an entry in both the numeric and string value dictionaries,
         // possibly zero(-length) if no number or no string value was supplied. First
         // check: does name already exist in hash?
-        if (StringMap.count(regParse[1]) or NumMap.count(regParse[1])) {
+        if (entry) {
             // name exists in hash, so override or keep existing value as appropriate
-            cerr << " *Warning DataBase::ReadFile2: "
-                 << (overwrite != kKeep ? "OVERRIDING" : "PRESERVING")
-                 << " previous setting of " << key << endl;
-            if (overwrite != kKeep) {
+            Warn(overwrite != kKeep ? kOverridden : kPreserved, key);
+            if (overwrite == kKeep) {
                 continue;
             }
         } else {
             // name does not exist in hash, so add to vector of keys
-            KeyList.push_back(key);
+            KeyList.push_back(Intern(key));
         }
 
-        if (NbMatch > 7) {
-            StringMap[key] = regParse.at(7);
-        }  // case 'name numeric string [comment]'
-        if (NbMatch > 3) {  // case 'name numeric [comment]' or 'name string [comment]'
-            if (regNum.Match(regParse.at(3))) {
-                NumMap[key] = regParse.stod(3);
-                StringMap[key];
-            } else {
-                NumMap[key] = 0.;
-                StringMap[key] = regParse.at(3);
-            }
+        const bool HasText = not record.Text.empty();
+        if (not HasText and not record.HasNumber) {  // case 'name [comment]'
+            n++;
+            continue;
+        }
+        if (not entry) {
+            entry = &Insert(KeyList.back(), hash);
+        }
+        if (HasText) {  // case 'name [numeric] string [comment]'
+            entry->HasStr = true;
+            entry->Str = std::move(record.Text);
+        }
+        if (record.HasNumber) {  // case 'name numeric [string] [comment]'
+            entry->HasNum = true;
+            entry->Num = record.Number;
+            entry->HasStr = true;
+        } else {  // case 'name string [comment]'
+            entry->HasNum = true;
+            entry->Num = 0.;
         }
         n++;
     }
 #ifdef DEBUG
     cout << " --- Database successfully read: " << n << " elements found ---\n";
 #endif
+
+    if (staging.Error) {
+        std::rethrow_exception(staging.Error);
+    }
 }
 
 ////////////////////////////////////////////////////////////////
-/// ReadFile: read from a file of the given name.
-void DataBase::ReadFile(
-    const char* filename,
-    const char* env_path,
-    const char* prefix,
-    DataBase::EOverwrite overwrite) {
-    string FileWithPath = filename;
-    if (env_path) {
-        FileWithPath = GetPath(env_path) + FileWithPath;
+/// FormatParameters: append the parameters to the buffer, in the order in which they
+/// were read in, a line per key: key [number] [: string]
+void DataBase::FormatParameters(string& buffer) const {
+    buffer.reserve(buffer.size() + 32 * KeyList.size());
+    for (std::string_view key : KeyList) {
+        buffer += key;
+        const Entry* entry = Find(key);
+        if (entry and entry->HasNum) {
+            buffer += ' ';
+            detail_database::AppendNumber(buffer, entry->Num);
+        }
+        if (entry and entry->HasStr and not entry->Str.empty()) {
+            buffer += " : ";
+            buffer += entry->Str;
+        }
+        buffer += '\n';
     }
+}
 
-    if (IsReadOnly) {
-        throw DataBaseError(
-            " ***Error DataBase::ReadFile2: Read-only database, can not update: ",
-            FileWithPath);
+////////////////////////////////////////////////////////////////
+/// Warn: count a warning of the reading, keep it if among the first, print it if asked
+void DataBase::Warn(DataBase::EWarning warning, std::string_view example) {
+    if (Diags.Examples[warning].size() < Diagnostics::kNbExamples) {
+        Diags.Examples[warning].emplace_back(example);
     }
-
-#ifdef DEBUG
-    cout << " Attempting to read database from file " << FileWithPath << endl;
-#endif
-
-    ifstream ifs;
-    ifs.open(FileWithPath, std::ios::in);
-    if (! ifs.is_open() || ! ifs.good()) {
-        throw DataBaseError(
-            " ***Error DataBase::ReadFile3: Could not open: ", FileWithPath);
+    Diags.Count[warning]++;
+
+    if (Verbosity == kVerbose) {  // a single write for the whole message
+        if (warning == kBadLine) {
+            cerr << cat(
+                " *Warning DataBase::ReadFile1: Bad format of line ",
+                example,
+                "\nSkipping...\n");
+        } else if (warning == kCache) {
+            cerr << cat(" *Warning DataBase::ReadFile4: ", example, '\n');
+        } else {
+            cerr << cat(
+                " *Warning DataBase::ReadFile2: ",
+                warning == kOverridden ? "OVERRIDING" : "PRESERVING",
+                " previous setting of ",
+                example,
+                '\n');
+        }
     }
+}
 
-    if (prefix) {
-        ReadFile(ifs, prefix, overwrite);
-    } else {
-        ReadFile(ifs, "", overwrite);
+////////////////////////////////////////////////////////////////
+/// Report: print the number of warnings of each kind with the first ones, if asked
+void DataBase::Report() const {
+    if (Verbosity != kSummary) {
+        return;
+    }
+    static const char* const what[kNbWarnings] = {
+        "lines of bad format skipped",
+        "keys defined again, OVERRIDING the previous setting",
+        "keys defined again, PRESERVING the previous setting",
+        "binary images of the files ignored or not written"};
+    string report;
+    for (int warning = 0; warning < kNbWarnings; warning++) {
+        if (Diags.Count[warning] == 0) {
+            continue;
+        }
+        report += cat(" *Warning DataBase::ReadFile: ", Diags.Count[warning], " ");
+        report += cat(what[warning], ", such as:\n");
+        for (const string& example : Diags.Examples[warning]) {
+            report += cat("    ", example, '\n');
+        }
     }
-    ifs.close();
+    cerr << report;
 }
 
 ////////////////////////////////////////////////////////////////
 
+/// WriteText: the text is formatted in a buffer, written in large blocks
 void DataBase::WriteText(ostream& os) const {
     // write out parameters in the same order in which they were read in
-    os.precision(15);
-    for (size_t i = 0; i != KeyList.size(); i++) {
-        const string& key(KeyList[i]);
-        os << key;
-        if (HasNumValue(key)) {
-            os << ' ' << NumMap.at(key);
+    string buffer;
+    FormatParameters(buffer);
+    os.write(buffer.data(), buffer.size());
+    buffer.clear();
+
+    // write out tables (in the alphabetical order)
+    const vector<const Entry*> tables = GetSortedTables();
+    for (const Entry* entry : tables) {
+        buffer += "\n\n";
+        buffer += entry->Key;
+        buffer += '\n';
+        entry->Table->Format(buffer);
+        if (buffer.size() >= detail_database::kTextBlock) {
+            os.write(buffer.data(), buffer.size());
+            buffer.clear();
         }
-        if (HasStrValue(key)) {
-            os << " : " << StringMap.at(key);
-        }
-        os << endl;
-    }
-    os.flush();
-
-    // write out tables (in the map order, i.e. not ordered)
-    for (auto itMap = TableMap.begin(), endMap = TableMap.end(); itMap != endMap;
-         ++itMap) {
-        os << "\n\n" << (*itMap).first << "\n";
-        (*itMap).second->Print(os);
     }
+    os.write(buffer.data(), buffer.size());
     os.flush();
 
     cout << " --- Database successfully written in text file: " << KeyList.size()
-         << " parameters and " << TableMap.size() << " tables ---\n";
+         << " parameters and " << tables.size() << " tables ---\n";
 }
 ////////////////////////////////////////////////////////////////
 /// WriteFile: write to a file of the given name.
@@ -254,9 +1728,10 @@ void DataBase::WriteText(const char* filename, const char* env_path) const {
 
     cout << " Attempting to write database on text file: " << FileWithPath << endl;
     ofstream ofs;
-    ofs.open(filename, std::ios::out);
+    ofs.open(FileWithPath, std::ios::out);
     if (! ofs.is_open() || ! ofs.good()) {
-        throw DataBaseError(" ***Error DataBase::WriteText: Could not open ", filename);
+        throw DataBaseError(
+            " ***Error DataBase::WriteText: Could not open ", FileWithPath);
     }
 
     WriteText(ofs);
@@ -264,26 +1739,152 @@ void DataBase::WriteText(const char* filename, const char* env_path) const {
 }
 
 ////////////////////////////////////////////////////////////////
+/// WriteBinary: write the binary image of the database, see ReadBinary
+void DataBase::WriteBinary(ostream& os) const {
+    // the keys in the order in which they were read in, including the tables
+    detail_database::ImageWriter writer;
+    for (std::string_view key : KeyList) {
+        const Entry* entry = Find(key);
+        if (entry and entry->Table) {
+            writer.Table(key, *entry->Table);
+        } else if (entry) {
+            writer.Parameter(key, entry->HasNum, entry->Num, entry->Str);
+        } else {
+            writer.Parameter(key, false, 0., "");
+        }
+    }
+    const string& image = writer.Finish();
+    os.write(image.data(), image.size());
+    os.flush();
+}
+////////////////////////////////////////////////////////////////
+void DataBase::WriteBinary(const char* filename, const char* env_path) const {
+    string FileWithPath = filename;
+    if (env_path) {
+        FileWithPath = GetPath(env_path) + FileWithPath;
+    }
+
+    ofstream ofs;
+    ofs.open(FileWithPath, std::ios::out | std::ios::binary);
+    if (! ofs.is_open() || ! ofs.good()) {
+        throw DataBaseError(
+            " ***Error DataBase::WriteBinary: Could not open ", FileWithPath);
+    }
+
+    WriteBinary(ofs);
+    ofs.close();
+}
+
+////////////////////////////////////////////////////////////////
+
+double DataBase::GetNumValue(std::string_view key) const {
+    return GetNumValue(Key(key));
+}
 
-double DataBase::GetNumValue(const string& key) const {
-    if (NumMap.count(key) == 0) {
+double DataBase::GetNumValue(const Key& key) const {
+    const Entry* entry = Find(key.Name, key.Hash);
+    if (not entry or not entry->HasNum) {
         // if application code is using this method, it's just reading the db, not
         // assigning to it. This is always an error in DataBase if the key is not yet
         // defined.
         throw DataBaseError(
-            " ***Error DataBase::GetNumValue: Attempt to retrieve undefined key ", key);
+            " ***Error DataBase::GetNumValue: Attempt to retrieve undefined key ",
+            key.Name);
+    }
+    return entry->Num;
+}
+
+////////////////////////////////////////////////////////////////
+
+const string& DataBase::GetStrValue(std::string_view key) const {
+    return GetStrValue(Key(key));
+}
+
+const string& DataBase::GetStrValue(const Key& key) const {
+    const Entry* entry = Find(key.Name, key.Hash);
+    if (not entry or not entry->HasStr) {
+        throw DataBaseError(
+            " ***Error DataBase::GetStrValue: Attempt to retrieve undefined key ",
+            key.Name);
+    }
+    return entry->Str;
+}
+
+////////////////////////////////////////////////////////////////
+
+DataBase::Handle DataBase::GetHandle(const Key& key) const {
+    const Entry* entry = Find(key.Name, key.Hash);
+    if (not entry) {
+        throw DataBaseError(
+            " ***Error DataBase::GetHandle: Attempt to retrieve undefined key ",
+            key.Name);
     }
-    return NumMap.at(key);
+    return Handle(entry);
 }
 
 ////////////////////////////////////////////////////////////////
+/// GetHandlesWithPrefix: the range of the sorted keys beginning with "prefix."
+vector<DataBase::Handle> DataBase::GetHandlesWithPrefix(std::string_view prefix) const {
+    const string dotted = prefix.empty() ? string() : cat(prefix, ".");
+    vector<Handle> handles;
+
+    std::lock_guard<std::mutex> lock(Sorted.Mutex);
+    vector<const Entry*>& sorted = Sorted.Entries;
+    if (sorted.size() != Entries.size()) {
+        sorted.clear();
+        for (const Entry& entry : Entries) {
+            sorted.push_back(&entry);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) {
+            return a->Key < b->Key;
+        });
+    }
+
+    auto it = std::lower_bound(
+        sorted.begin(),
+        sorted.end(),
+        std::string_view(dotted),
+        [](const Entry* entry, std::string_view key) { return entry->Key < key; });
+    for (; it != sorted.end() and (*it)->Key.substr(0, dotted.size()) == dotted; ++it) {
+        if (not (*it)->Table) {
+            handles.push_back(Handle(*it));
+        }
+    }
+    return handles;
+}
 
-const string& DataBase::GetStrValue(const string& key) const {
-    if (StringMap.count(key) == 0) {
+////////////////////////////////////////////////////////////////
+/// GetNumValues: check all the keys, then copy their numeric values
+void DataBase::GetNumValues(
+    std::string_view prefix,
+    const vector<std::string_view>& keys,
+    double* values) const {
+    string key(prefix);
+    if (not prefix.empty()) {
+        key += '.';
+    }
+    const size_t size = key.size();
+
+    vector<const Entry*> entries;
+    entries.reserve(keys.size());
+    string missing;
+    for (std::string_view name : keys) {
+        key.resize(size);
+        key += name;
+        const Entry* entry = Find(key);
+        if (not entry or not entry->HasNum) {
+            missing += cat(" ", key);
+        }
+        entries.push_back(entry);
+    }
+    if (not missing.empty()) {
         throw DataBaseError(
-            " ***Error DataBase::GetStrValue: Attempt to retrieve undefined key ", key);
+            " ***Error DataBase::GetNumValues: No numeric value for keys:", missing);
+    }
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        values[i] = entries[i]->Num;
     }
-    return StringMap.at(key);
 }
 
 ////////////////////////////////////////////////////////////////
@@ -293,16 +1894,20 @@ double& DataBase::operator[](const string& key) {
         throw DataBaseError(
             " ***Error DataBase::operator[]: Attempt to modify read-only base: ", key);
     }
-    if (NumMap.count(key) != 0) {
+    const hash_t hash = strhash(key);
+    Entry* entry = Find(key, hash);
+    if (entry and entry->HasNum) {
         //     throw parambase_except(" ***Error DataBase::operator[]2: Attempt to
         //     create already existing key: ", key);
         cerr << " *Warning DataBase::operator[]: Overriding existing key: " << key
              << "\n";
     }
-    if (StringMap.count(key) == 0) {
-        KeyList.push_back(key);
+    if (not entry) {
+        KeyList.push_back(Intern(key));
+        entry = &Insert(KeyList.back(), hash);
     }  // the key may have been already created with just a string value
-    return NumMap[key];
+    entry->HasNum = true;
+    return entry->Num;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -312,113 +1917,432 @@ string& DataBase::operator()(const string& key) {
         throw DataBaseError(
             " ***Error DataBase::operator()1: Attempt to modify read-only base: ", key);
     }
-    if (StringMap.count(key) != 0) {
+    const hash_t hash = strhash(key);
+    Entry* entry = Find(key, hash);
+    if (entry and entry->HasStr) {
         //     throw parambase_except(" ***Error DataBase::operator()2: Attempt to
         //     create already existing key: ", key);
         cerr << " *Warning DataBase::operator(): Overriding existing key: " << key
              << "\n";
     }
-    if (NumMap.count(key) == 0) {
-        KeyList.push_back(key);
+    if (not entry) {
+        KeyList.push_back(Intern(key));
+        entry = &Insert(KeyList.back(), hash);
     }  // the key may have been already created with just a numeric value
-    return StringMap[key];
+    entry->HasStr = true;
+    return entry->Str;
 }
 
 ////////////////////////////////////////////////////////////////
 
-const std::shared_ptr<DataTable> DataBase::GetTablePtr(const char* name) const {
-    if (TableMap.count(string(name)) == 0) {
+const std::shared_ptr<DataTable> DataBase::GetTablePtr(std::string_view name) const {
+    const Entry* entry = Find(name);
+    if (not entry or not entry->Table) {
         throw DataBaseError(
             " ***Error DataBase::GetTable:Attempt to access undefined table ", name);
     }
-    return TableMap.at(string(name));
+    return entry->Table;
+}
+
+////////////////////////////////////////////////////////////////
+/// Find: the entry of a key, nullptr if not found
+const DataBase::Entry* DataBase::Find(std::string_view key, hash_t hash) const {
+    if (Slots.empty()) {
+        return nullptr;
+    }
+    const size_t mask = Slots.size() - 1;
+    const auto high = static_cast<std::uint32_t>(hash >> 32);
+    for (size_t i = (hash ^ high) & mask;; i = (i + 1) & mask) {
+        const Slot& slot = Slots[i];
+        if (slot.Index == 0) {
+            return nullptr;
+        }
+        if (slot.Hash == high) {
+            const Entry& entry = Entries[slot.Index - 1];
+            if (entry.Key == key) {
+                return &entry;
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// Copy of a database, the tables are shared since they are immutable, and so are
+// the keys: the copy interns its new keys in its own arena, chained to the arena of
+// the base to keep the keys of the base alive.
+// The entries and their index are copied, not shared until the first write: a
+// Handle points to an entry, which the writes update in place, so the handles taken
+// on the copy before its first write would still point to the entries of the base.
+// Without keys nor tables an entry is small, and a copy costs about a sixth of the
+// reading of the same parameters, e.g. 110 ms for a million of them.
+DataBase::DataBase(const DataBase& base, bool isreadonly):
+    IsReadOnly(isreadonly),
+    Parser(base.Parser),
+    Loading(base.Loading),
+    ChunkSize(base.ChunkSize),
+    Cache(base.Cache),
+    Verbosity(base.Verbosity),
+    Sources(base.Sources),
+    Keys(std::make_shared<detail_database::KeyArena>(base.Keys)),
+    KeyList(base.KeyList),
+    Entries(base.Entries),
+    Slots(base.Slots) {}
+
+////////////////////////////////////////////////////////////////
+/// Intern: copy a key in the arena of the database, created when first needed
+std::string_view DataBase::Intern(std::string_view key) {
+    if (not Keys) {
+        Keys = std::make_shared<detail_database::KeyArena>();
+    }
+    return Keys->Intern(key);
+}
+
+////////////////////////////////////////////////////////////////
+/// Insert: create the entry of a key, interned and which must not exist yet
+DataBase::Entry& DataBase::Insert(std::string_view key, hash_t hash) {
+    // keep the load factor below 1/2, for short probe sequences
+    if (2 * (Entries.size() + 1) > Slots.size()) {
+        Rehash(std::max<size_t>(16, 2 * Slots.size()));
+    }
+    Entries.emplace_back();
+    Entry& entry = Entries.back();
+    entry.Key = key;
+    entry.Hash = hash;
+
+    const size_t mask = Slots.size() - 1;
+    const auto high = static_cast<std::uint32_t>(hash >> 32);
+    size_t i = (hash ^ high) & mask;
+    while (Slots[i].Index != 0) {
+        i = (i + 1) & mask;
+    }
+    Slots[i] = {high, static_cast<std::uint32_t>(Entries.size())};
+    return entry;
+}
+
+////////////////////////////////////////////////////////////////
+/// Rehash: rebuild the index with the given number of slots, a power of 2
+void DataBase::Rehash(size_t nb_slots) {
+    Slots.assign(nb_slots, {0, 0});
+    const size_t mask = nb_slots - 1;
+    for (size_t index = 0; index < Entries.size(); index++) {
+        const hash_t hash = Entries[index].Hash;
+        const auto high = static_cast<std::uint32_t>(hash >> 32);
+        size_t i = (hash ^ high) & mask;
+        while (Slots[i].Index != 0) {
+            i = (i + 1) & mask;
+        }
+        Slots[i] = {high, static_cast<std::uint32_t>(index + 1)};
+    }
+}
+
+////////////////////////////////////////////////////////////////
+/// GetSortedTables: the entries of the tables, in the alphabetical order
+vector<const DataBase::Entry*> DataBase::GetSortedTables() const {
+    vector<const Entry*> tables;
+    for (const Entry& entry : Entries) {
+        if (entry.Table) {
+            tables.push_back(&entry);
+        }
+    }
+    std::sort(tables.begin(), tables.end(), [](const Entry* a, const Entry* b) {
+        return a->Key < b->Key;
+    });
+    return tables;
 }
 
 ////////////////////////////////////////////////////////////////
 
-vector<double> DataTable::GetColumnAsNum(const string& colname) const {
-    if (ColMap.count(colname) == 0) {
-        throw DataBaseError(" ***Error DataTable::GetColumnAsNum: Unknown : ", colname);
+vector<double> DataTable::GetColumnAsNum(std::string_view colname) const {
+    const Column& column = FindColumn(colname, "GetColumnAsNum");
+    if (column.Type != kString) {
+        return column.Num;
     }
 
     vector<double> v;
-    for (auto& el : ColMap.at(colname)) {
-        v.push_back(stod(el));
+    v.reserve(column.Str.size());
+    for (auto& el : column.Str) {
+        v.push_back(ToNum(el, "GetColumnAsNum"));
     }
     return v;
 }
 
+////////////////////////////////////////////////////////////////
+/** ToNum: a cell of a text column read as a number, see ToNumber, or else its
+    beginning read as the number of a parameter. Throw if there is none. */
+double DataTable::ToNum(const string& cell, const char* method) {
+    double value;
+    if (detail_database::ToNumber(cell, value)) {
+        return value;
+    }
+    const std::string_view number = std::string_view(cell).substr(
+        0, detail_database::ScanNumber(cell, 0));
+    if (number.empty() or not detail_database::ToNumber(number, value)) {
+        throw DataBaseError(" ***Error DataTable::", method, ": Not a number: ", cell);
+    }
+    return value;
+}
+
+////////////////////////////////////////////////////////////////
+/// Get a numeric column, without any conversion nor copy
+DataTable::View<double> DataTable::GetNumColumn(std::string_view colname) const {
+    return {GetArray<double>(colname, "GetNumColumn"), size_t(NbRow)};
+}
+
+////////////////////////////////////////////////////////////////
+/// Get a column of integers, without any conversion nor copy
+DataTable::View<std::int64_t> DataTable::GetIntColumn(std::string_view colname) const {
+    return {GetArray<std::int64_t>(colname, "GetIntColumn"), size_t(NbRow)};
+}
+
+////////////////////////////////////////////////////////////////
+/// Build an index now, instead of at the first lookup
+void DataTable::BuildIndex(std::string_view colname, DataTable::EIndex index) const {
+    const Column& column = FindColumn(colname, "BuildIndex");
+    if (index == kSorted) {
+        GetSorted(column);
+    } else if (column.Type == kInt) {
+        GetIntSlots(column);
+    } else {
+        GetTextSlots(column);
+    }
+}
+
+////////////////////////////////////////////////////////////////
+int DataTable::FindRow(std::string_view colname, std::int64_t value) const {
+    const Column& column = FindColumn(colname, "FindRow");
+    if (column.Type != kInt) {
+        throw DataBaseError(
+            " ***Error DataTable::FindRow: Not an integer column: ", colname);
+    }
+    return detail_database::FindSlot(
+        GetIntSlots(column), value, [&](int row) { return column.Int[row] == value; });
+}
+
+int DataTable::FindRow(std::string_view colname, std::string_view value) const {
+    const Column& column = FindColumn(colname, "FindRow");
+    return detail_database::FindSlot(
+        GetTextSlots(column), strhash(value), [&](int row) {
+            return column.Str[row] == value;
+        });
+}
+
+////////////////////////////////////////////////////////////////
+DataTable::View<int> DataTable::RowsInRange(
+    std::string_view colname, double lo, double hi) const {
+    const Column& column = FindColumn(colname, "RowsInRange");
+    if (column.Type == kString) {
+        throw DataBaseError(
+            " ***Error DataTable::RowsInRange: Not a numeric column: ", colname);
+    }
+    const vector<int>& sorted = GetSorted(column);
+    const double* Num = column.Num.data();
+    auto first = std::lower_bound(
+        sorted.begin(), sorted.end(), lo, [&](int row, double value) {
+            return Num[row] < value;
+        });
+    // from first, so that last is never before first, even if hi < lo
+    auto last = std::upper_bound(first, sorted.end(), hi, [&](double value, int row) {
+        return value < Num[row];
+    });
+    return {sorted.data() + (first - sorted.begin()), size_t(last - first)};
+}
+
+////////////////////////////////////////////////////////////////
+/// The indexes, built once even if several threads ask for them at the same time
+const vector<int>& DataTable::GetIntSlots(const Column& column) const {
+    Index& index = *column.Indexes;
+    std::call_once(index.IntOnce, [&]() {
+        const std::int64_t* Int = column.Int.data();
+        index.IntSlots = detail_database::BuildSlots(
+            NbRow,
+            [&](int row) { return hash_t(Int[row]); },
+            [&](int row1, int row2) { return Int[row1] == Int[row2]; });
+    });
+    return index.IntSlots;
+}
+
+const vector<int>& DataTable::GetTextSlots(const Column& column) const {
+    Index& index = *column.Indexes;
+    std::call_once(index.TextOnce, [&]() {
+        const string* Str = column.Str.data();
+        index.TextSlots = detail_database::BuildSlots(
+            NbRow,
+            [&](int row) { return strhash(Str[row]); },
+            [&](int row1, int row2) { return Str[row1] == Str[row2]; });
+    });
+    return index.TextSlots;
+}
+
+const vector<int>& DataTable::GetSorted(const Column& column) const {
+    Index& index = *column.Indexes;
+    std::call_once(index.SortedOnce, [&]() {
+        const double* Num = column.Num.data();
+        index.Sorted.reserve(NbRow);
+        for (int row = 0; row < NbRow; row++) {
+            if (not std::isnan(Num[row])) {  // not ordered
+                index.Sorted.push_back(row);
+            }
+        }
+        std::stable_sort(index.Sorted.begin(), index.Sorted.end(), [&](int a, int b) {
+            return Num[a] < Num[b];
+        });
+    });
+    return index.Sorted;
+}
+
+////////////////////////////////////////////////////////////////
+/** SetTypes: infer the type of each column from all its cells, see ToNumber for the
+    numbers. An integer is a cell entirely read as a std::int64_t.
+ */
+void DataTable::SetTypes() {
+    vector<Column*> columns;
+    for (auto& name_column : ColMap) {
+        columns.push_back(&name_column.second);
+    }
+    // the columns are independent, so that a large table is typed concurrently
+    const size_t nb_cells = columns.size() * NbRow;
+    const unsigned nb_threads = nb_cells < detail_database::kParallelCells ? 1 : 0;
+    detail_database::ParallelFor(columns.size(), nb_threads, [&columns](size_t i) {
+        Column& column = *columns[i];
+        column.Type = kInt;
+        column.Num.reserve(column.Str.size());
+        column.Int.reserve(column.Str.size());
+        for (const string& cell : column.Str) {
+            const char* begin = cell.c_str();
+            const char* end = begin + cell.size();
+            if (column.Type == kInt) {
+                std::int64_t value;
+                const auto result = std::from_chars(begin, end, value);
+                if (result.ec == std::errc() and result.ptr == end) {
+                    column.Int.push_back(value);
+                    // converted once, keeping the sign of "-0" as ToNumber does
+                    const bool minus_zero = value == 0 and *begin == '-';
+                    column.Num.push_back(minus_zero ? -0. : static_cast<double>(value));
+                    continue;
+                }
+                column.Type = kDouble;
+            }
+
+            double value;
+            if (not detail_database::ToNumber(cell, value)) {
+                column.Type = kString;
+                break;
+            }
+            column.Num.push_back(value);
+        }
+
+        if (column.Type != kInt) {
+            vector<std::int64_t>().swap(column.Int);
+        }
+        if (column.Type == kString) {
+            vector<double>().swap(column.Num);
+        }
+    });
+}
+
 ////////////////////////////////////////////////////////////////
 ///////////////////////// DataTable ///////////////////////////
 ////////////////////////////////////////////////////////////////
 
+/// Create a DataTable object from its columns, read from a binary image
+DataTable::DataTable(vector<string> colnames, vector<Column> columns, int nbrow):
+    ColNames(std::move(colnames)), NbRow(nbrow) {
+    for (size_t i = 0; i < ColNames.size(); i++) {
+        ColMap.emplace(ColNames[i], std::move(columns[i]));
+    }
+}
+
+////////////////////////////////////////////////////////////////
 /** Create a DataTable object and initialize it from a file.
     It may seem strange that no "ReadFile()" function is provided, and
     no default DataTable() constructor is provided, but this is intentional:
     no uninitialized tables are allowed, and once initialized, tables are
     intended to be immutable. */
-DataTable::DataTable(std::istream& is, std::string& line) {
+DataTable::DataTable(
+    detail_database::LineReader& reader,
+    std::string_view header,
+    DataBase::EParser parser,
+    std::size_t chunk_size) {
 #ifdef DEBUG
     cout << " Attempting to read table from file " << filename << endl;
 #endif
 
-    size_t NbCol = 0;
-    string header = line;
-    Regex regSharp("#");
-    Regex regSpace("\\s+");
-    Regex regComment("\\s*#.*$");
-
-    // parse header line
-    // remove '=tablename=' and possible spaces
-    Regex("^=\\w+=\\s*").Substitute(header, "");
-    // check if a comment is a the end of the line
-    while (regSharp.Match(header)) {
-        regComment.Substitute(header, "");
-    }  // remove if necessary
-
-    // split the string on spaces
-    NbCol = regSpace.Split(header).size();
-    for (size_t i = 0; i < NbCol; i++) {
-        ColNames.push_back(regSpace.at(i));
-        ColMap[regSpace.at(i)].reserve(10);  // forces column vector to be defined
-    }
-
-    // process the data lines
-    while (getline(is, line).good()) {
-        if (is.fail()) {
-            break;
+    vector<Col_t*> columns;  // in the order of the names, to fill them without lookup
+    auto set_names = [this, &columns](const vector<std::string_view>& names) {
+        for (std::string_view name : names) {
+            ColNames.emplace_back(name);
+            columns.push_back(&ColMap[ColNames.back()].Str);
+            columns.back()->reserve(10);
         }
+    };
+
+    if (parser == DataBase::kRegex) {  // the legacy engine, line by line
+        detail_database::ParseTable(
+            reader,
+            header,
+            parser,
+            "DataTable::DataTable1",
+            set_names,
+            [this, &columns](const std::string_view* cells) {
+                for (size_t i = 0; i < columns.size(); i++) {
+                    columns[i]->emplace_back(cells[i]);
+                }
+                NbRow++;
+            });
+        SetTypes();
+        return;
+    }
 
-        // skip lines beginning with '#'
-        if (line.front() == '#') {
-            continue;
+    // the body is parsed by chunks, concurrently if it is large enough and threads
+    // are available: the first chunk directly in the columns, the others in their
+    // own, moved at the end
+    vector<std::string_view> names;
+    detail_database::StripTableName(header);
+    detail_database::StripComment(header);
+    detail_database::SplitOnSpace(header, names);
+    set_names(names);
+
+    string storage;
+    vector<detail_database::TableChunk> chunks = detail_database::SplitInChunks(
+        detail_database::ReadTableBody(reader, storage), chunk_size);
+    detail_database::ParallelFor(chunks.size(), 0, [&chunks, &columns](size_t i) {
+        if (i == 0) {
+            detail_database::ParseChunk(chunks[i], columns);
+            return;
         }
-        while (regSharp.Match(line)) {
-            regComment.Substitute(line, "");
-        }  // remove if necessary
-
-        // end of the table at the first blank line
-        if (line.empty() || line.find_first_not_of(' ') == string::npos) {
-            break;
+        vector<Col_t*> own;
+        chunks[i].Columns.resize(columns.size());
+        for (auto& column : chunks[i].Columns) {
+            own.push_back(&column);
         }
+        detail_database::ParseChunk(chunks[i], own);
+    });
 
-        // parse the line
-        if (regSpace.Split(line).size() - 1 != NbCol) {
+    for (const auto& chunk : chunks) {
+        if (chunk.BadSize) {
             throw DataBaseError(
                 " ***Error DataTable::DataTable1: Bad line, expected ",
-                NbCol,
+                columns.size(),
                 " columns, got ",
-                regSpace.Nb(),
+                chunk.BadSize,
                 " values on row ",
-                NbRow);
+                NbRow + chunk.NbRow);
         }
-
-        // all is well, push back the data!
-        for (size_t i = 0; i < NbCol; i++) {
-            ColMap[ColNames.at(i)].push_back(regSpace.at(i + 1));
+        NbRow += chunk.NbRow;
+    }
+    for (size_t i = 0; i < columns.size(); i++) {
+        columns[i]->reserve(NbRow);
+        for (auto& chunk : chunks) {
+            if (chunk.Columns.empty()) {  // the first one
+                continue;
+            }
+            std::move(
+                chunk.Columns[i].begin(),
+                chunk.Columns[i].end(),
+                std::back_inserter(*columns[i]));
         }
-        NbRow++;
     }
+    SetTypes();
 
 #ifdef DEBUG
     cout << " --- Table successfully defined with " << NbRow << " rows and "
@@ -429,17 +2353,86 @@ DataTable::DataTable(std::istream& is, std::string& line) {
 ////////////////////////////////////////////////////////////////
 
 void DataTable::Print(std::ostream& os) const {
+    string buffer;
+    Format(buffer);
+    os.write(buffer.data(), buffer.size());
+}
+
+////////////////////////////////////////////////////////////////
+/// Format: append the table to the buffer, a tab before each cell
+void DataTable::Format(string& buffer) const {
+    vector<const vector<string>*> columns;
+    columns.reserve(ColNames.size());
+    size_t size = 0;
+    for (auto& name : ColNames) {
+        columns.push_back(&ColMap.at(name).Str);
+        size += 1 + name.size();
+        for (const string& cell : *columns.back()) {
+            size += 1 + cell.size();
+        }
+    }
+    buffer.reserve(buffer.size() + size + NbRow + 1);
+
     for (auto& name : ColNames) {
-        os << "\t" << name;
+        buffer += '\t';
+        buffer += name;
     }
-    os << "\n";
+    buffer += '\n';
 
     for (int iRow = 0; iRow < NbRow; iRow++) {
-        for (auto it = ColNames.begin(), end = ColNames.end(); it != end; ++it) {
-            os << "\t" << ColMap.at(*it).at(iRow);
+        for (const vector<string>* column : columns) {
+            buffer += '\t';
+            buffer += (*column)[iRow];
+        }
+        buffer += '\n';
+    }
+}
+
+////////////////////////////////////////////////////////////////
+////////////////////////// TableRow ////////////////////////////
+////////////////////////////////////////////////////////////////
+
+int TableRow::GetColumn(std::string_view colname) const {
+    for (size_t i = 0; i < ColNames.size(); i++) {
+        if (ColNames[i] == colname) {
+            return static_cast<int>(i);
         }
-        os << "\n";
     }
+    throw DataBaseError(" ***Error TableRow::GetColumn: Unknown column: ", colname);
+}
+
+////////////////////////////////////////////////////////////////
+/// GetNum: the cell read as a number, as in a DataTable, or throw
+double TableRow::GetNum(int col) const {
+    double value;
+    if (not detail_database::ToNumber(Cells[col], value)) {
+        throw DataBaseError(
+            " ***Error TableRow::GetNum: Not a number in column ",
+            ColNames.at(col),
+            " on row ",
+            Row,
+            ": ",
+            Cells[col]);
+    }
+    return value;
+}
+
+////////////////////////////////////////////////////////////////
+/// GetInt: the cell entirely read as an integer, as in a DataTable, or throw
+std::int64_t TableRow::GetInt(int col) const {
+    const std::string_view cell = Cells[col];
+    std::int64_t value;
+    const auto result = std::from_chars(cell.data(), cell.data() + cell.size(), value);
+    if (result.ec != std::errc() or result.ptr != cell.data() + cell.size()) {
+        throw DataBaseError(
+            " ***Error TableRow::GetInt: Not an integer in column ",
+            ColNames.at(col),
+            " on row ",
+            Row,
+            ": ",
+            cell);
+    }
+    return value;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -459,48 +2452,25 @@ void DataBase::WriteRoot(TFile* file) const {
     string SaveStr;
 
     // write out parameters in the same order in which they were read in
-    for (size_t i = 0; i != KeyList.size(); i++) {
-        const string& key(KeyList[i]);
-        SaveStr += key;
-        if (HasNumValue(key)) {
-            SaveStr += cat(" ", NumMap.at(key));
-        }
-        if (HasStrValue(key)) {
-            SaveStr += cat(" : ", StringMap.at(key));
-        }
-        SaveStr += "\n";
-    }
+    FormatParameters(SaveStr);
     ObjStr.SetString(SaveStr.c_str());
     ObjStr.Write("Parameters");
 
-    // write out tables (in the map order, i.e. not ordered)
-    for (auto itMap = TableMap.begin(), endMap = TableMap.end(); itMap != endMap;
-         ++itMap) {
-        SaveStr.clear();
-        SaveStr = cat("\n\n", (*itMap).first, "\n");
-
-        auto tab = (*itMap).second;
-        const vector<string>* ColNames = &tab->GetColumnNames();
-        for (auto itV = ColNames->begin(), end = ColNames->end(); itV != end; ++itV) {
-            SaveStr += cat("\t", *itV);
-        }
-        SaveStr += "\n";
-
-        for (int iRow = 0; iRow < tab->GetNbRows(); iRow++) {
-            for (auto itV = ColNames->begin(), end = ColNames->end(); itV != end; ++itV)
-            {
-                SaveStr += cat("\t", (*tab)[*itV].at(iRow));
-            }
-            SaveStr += "\n";
-        }
+    // write out tables (in the alphabetical order)
+    const vector<const Entry*> tables = GetSortedTables();
+    for (const Entry* entry : tables) {
+        SaveStr = "\n\n";
+        SaveStr += entry->Key;
+        SaveStr += '\n';
+        entry->Table->Format(SaveStr);
 
         ObjStr.SetString(SaveStr.c_str());
-        ObjStr.Write(cat("Table ", (*itMap).first));
+        ObjStr.Write(cat("Table ", entry->Key));
     }
 
     dir->cd();  // back to previous directory
     cout << " --- Database successfully written in ROOT file " << file->GetName()
-         << ": " << KeyList.size() << " parameters and " << TableMap.size()
+         << ": " << KeyList.size() << " parameters and " << tables.size()
          << " tables ---\n";
 }
 
@@ -510,7 +2480,7 @@ void DataBase::WriteRoot(const char* filename) const {
     cout << " Attempting to write database on ROOT file " << filename << endl;
     TFile file(filename, "RECREATE");
     if (! file.IsOpen()) {
-        throw parambase_except(
+        throw DataBaseError(
             " ***Error DataBase::WriteRoot1: Could not open ", filename);
     }
     WriteRoot(&file);
@@ -0,0 +1,457 @@
+"""Unitary tests of DataBase.hh"""
+
+import array
+import os
+import struct
+
+import cppyy
+import pytest
+import PyTools
+
+std = cppyy.gbl.std
+
+DataBase = PyTools.tools.DataBase
+
+CONTENT = """# blank lines and lines beginning with '#' are ignored
+
+pi  3.14159265358979312  # any character after the '#' are ignored
+model  INCL++            # any space before the '#' are ignored
+e  2.71828182845904509e+00  This is 'e' as in exp(1), not the e+ charge.
+q_e 1.60217646200000007e-19 coulomb  # Charge of the positron in coulombs
+signed -6.43e+20
+comma 6,43e-20
+truncated 12abc
+alone
+pi 4
+"""
+
+
+def read(content, prefix, parser):
+    """Read the content in the database with the given prefix and parser"""
+    db = DataBase.GetInputDataBase()
+    db.SetParser(parser)
+    db.ReadFile(std.istringstream(content), prefix, DataBase.kKeep)
+    db.SetParser(DataBase.kTokenizer)
+    return db
+
+
+def test_read_file():
+    """Unitary test of tools::DataBase::ReadFile"""
+    db = read(CONTENT, "token", DataBase.kTokenizer)
+    assert db.GetNumValue("token.pi") == 3.14159265358979312
+    assert db.GetStrValue("token.pi") == ""
+    assert db.GetNumValue("token.model") == 0
+    assert db.GetStrValue("token.model") == "INCL++"
+    assert db.GetStrValue("token.e") == "This is 'e' as in exp(1), not the e+ charge."
+    assert db.GetNumValue("token.q_e") == 1.60217646200000007e-19
+    assert db.GetStrValue("token.q_e") == "coulomb"
+    assert db.GetNumValue("token.signed") == -6.43e20
+    assert db.GetNumValue("token.comma") == 6.43e-20
+    assert db.GetNumValue("token.truncated") == 12
+    assert not db.HasNumValue("token.alone")
+
+
+def test_default_overwrite(tmp_path):
+    """By default, the readings keep the last value of a key defined again"""
+    db = DataBase()
+    db.SetVerbosity(DataBase.kQuiet)
+    db.ReadFile(std.istringstream(CONTENT))
+    assert db.GetNumValue("pi") == 4
+    assert db.GetDiagnostics().Count[DataBase.kOverridden] == 1
+
+    filename = tmp_path / "first.txt"
+    filename.write_text("layered 1\n")
+    db.ReadFile(str(filename))
+    filename = tmp_path / "second.txt"
+    filename.write_text("layered 2\n")
+    files = std.vector[DataBase.InputFile]([DataBase.InputFile(str(filename), "", "")])
+    db.ReadFiles(files)
+    assert db.GetNumValue("layered") == 2
+
+    image = DataBase()
+    image.ReadFile(std.istringstream("layered 3\n"))
+    image.WriteBinary(str(tmp_path / "layered.bin"))
+    db.ReadBinary(str(tmp_path / "layered.bin"))
+    assert db.GetNumValue("layered") == 3
+
+
+def test_parsers():
+    """Both parsers of tools::DataBase::ReadFile yield the same content"""
+    db = read(CONTENT, "fast", DataBase.kTokenizer)
+    read(CONTENT, "legacy", DataBase.kRegex)
+    keys = [str(key) for key in db.GetListOfKeys()]
+    fast_keys = [key[len("fast.") :] for key in keys if key.startswith("fast.")]
+    legacy_keys = [key[len("legacy.") :] for key in keys if key.startswith("legacy.")]
+    assert fast_keys == legacy_keys
+    for key in fast_keys:
+        assert db.HasNumValue("fast." + key) == db.HasNumValue("legacy." + key)
+        assert db.HasStrValue("fast." + key) == db.HasStrValue("legacy." + key)
+        if db.HasNumValue("fast." + key):
+            assert db.GetNumValue("fast." + key) == db.GetNumValue("legacy." + key)
+            assert db.GetStrValue("fast." + key) == db.GetStrValue("legacy." + key)
+
+
+def test_loading(tmp_path):
+    """Memory mapped and streamed files yield the same content"""
+    filename = tmp_path / "database.txt"
+    filename.write_text(CONTENT)
+    db = DataBase.GetInputDataBase()
+    db.ReadFile(str(filename), cppyy.nullptr, "mapped")
+    db.SetLoading(DataBase.kStream)
+    db.ReadFile(str(filename), cppyy.nullptr, "streamed")
+    db.SetLoading(DataBase.kMemoryMap)
+    for key in ("pi", "model", "e", "q_e", "signed", "truncated"):
+        assert db.GetNumValue("mapped." + key) == db.GetNumValue("streamed." + key)
+        assert db.GetStrValue("mapped." + key) == db.GetStrValue("streamed." + key)
+
+
+def test_read_files(tmp_path):
+    """ReadFiles yields the same content as successive calls to ReadFile"""
+    contents = [CONTENT, "pi 3\nnew 1 first\n", "new 2 second\nlast 42\n"]
+    InputFile = DataBase.InputFile
+    files = std.vector[InputFile]()
+    for i, content in enumerate(contents):
+        filename = tmp_path / f"database{i}.txt"
+        filename.write_text(content)
+        db = DataBase.GetInputDataBase()
+        db.ReadFile(str(filename), cppyy.nullptr, "sequential", DataBase.kOverride)
+        files.push_back(InputFile(str(filename), "", "parallel"))
+    db.ReadFiles(files, DataBase.kOverride)
+
+    keys = [str(key) for key in db.GetListOfKeys()]
+    sequential = [key.split(".", 1)[1] for key in keys if key.startswith("sequential.")]
+    parallel = [key.split(".", 1)[1] for key in keys if key.startswith("parallel.")]
+    assert sequential == parallel
+    for key in ("pi", "new", "last"):
+        assert db.GetNumValue("sequential." + key) == db.GetNumValue("parallel." + key)
+        assert db.GetStrValue("sequential." + key) == db.GetStrValue("parallel." + key)
+    assert db.GetNumValue("parallel.pi") == 3
+    assert db.GetStrValue("parallel.new") == "second"
+
+
+def test_handle():
+    """Unitary test of tools::DataBase::Handle and tools::DataBase::Key"""
+    db = read(CONTENT, "handle", DataBase.kTokenizer)
+    handle = db.GetHandle("handle.q_e")
+    assert handle.IsValid()
+    assert handle.GetKey() == "handle.q_e"
+    assert handle.GetNumValue() == 1.60217646200000007e-19
+    assert handle.GetStrValue() == "coulomb"
+    assert db.GetNumValue(DataBase.Key("handle.q_e")) == handle.GetNumValue()
+    assert DataBase.Key("handle.q_e").Hash == PyTools.tools.strhash("handle.q_e")
+
+    db.SetNumValue("handle.q_e", 42)
+    assert handle.GetNumValue() == 42
+
+
+def test_table_chunks(tmp_path):
+    """A table parsed by chunks inside ReadFiles is the same as when parsed serially"""
+    filename = tmp_path / "chunks.txt"
+    lines = ["=chunked= id x name"]
+    for i in range(2000):
+        if i % 300 == 0:
+            lines.append(f"# comment {i}")
+        lines.append(f" {i} {i / 4} n{i}")
+    filename.write_text("\n".join(lines) + "\n\nafter 1\n")
+    files = std.vector[DataBase.InputFile]([DataBase.InputFile(str(filename), "", "")])
+
+    serial = DataBase()
+    serial.ReadFiles(files, DataBase.kKeep, 1)
+    chunked = DataBase()
+    chunked.SetChunkSize(1000)
+    chunked.ReadFiles(files, DataBase.kKeep, 4)
+    table = chunked.GetTable("chunked")
+    assert table.GetNbRows() == 2000
+    assert table.GetColumnType("id") == PyTools.tools.DataTable.kInt
+    expected, result = std.string(), std.string()
+    serial.GetTable("chunked").Format(expected)
+    table.Format(result)
+    assert result == expected
+    assert chunked.GetNumValue("after") == 1
+
+
+def test_publish():
+    """Unitary test of tools::DataBase::Publish"""
+    db = read("published 1\n", "", DataBase.kTokenizer)
+    DataBase.Publish()
+    published = DataBase.GetDataBase()
+    assert published.GetNumValue("published") == 1
+
+    db = DataBase.GetInputDataBase()
+    db.SetNumValue("published", 2)
+    assert published.GetNumValue("published") == 1
+    assert DataBase.GetDataBase().GetNumValue("published") == 1
+    DataBase.Publish()
+    assert DataBase.GetDataBase().GetNumValue("published") == 2
+    assert published.GetNumValue("published") == 1
+
+
+def test_reload(tmp_path):
+    """Unitary test of tools::DataBase::Reload"""
+    filename = tmp_path / "reload.txt"
+    filename.write_text("reloaded 1\n")
+    DataBase.GetInputDataBase().ReadFile(str(filename), cppyy.nullptr, "")
+    DataBase.Publish()
+    snapshot = DataBase.GetSnapshot()
+    assert not DataBase.Reload(DataBase.kIfModified)
+
+    filename.write_text("reloaded 2\n")
+    mtime = filename.stat().st_mtime_ns + 1_000_000_000
+    os.utime(filename, ns=(mtime, mtime))
+    assert snapshot.IsModified()
+    assert DataBase.Reload(DataBase.kIfModified)
+    assert DataBase.GetSnapshot().GetNumValue("reloaded") == 2
+    assert DataBase.GetSnapshot().GetVersion() == snapshot.GetVersion() + 1
+    assert snapshot.GetNumValue("reloaded") == 1
+
+
+def test_reload_retired(tmp_path):
+    """Reload keeps the versions returned by GetDataBase alive, and only them"""
+    filename = tmp_path / "retired.txt"
+    filename.write_text("retired 1\n")
+    DataBase.GetInputDataBase().ReadFile(str(filename), cppyy.nullptr, "")
+    DataBase.Publish()
+    WeakPtr = std.weak_ptr["const tools::DataBase"]
+    versions = []
+    for _ in range(20):
+        versions.append(WeakPtr(DataBase.GetSnapshot().__smartptr__()))
+        assert DataBase.Reload()
+    assert all(version.expired() for version in versions)
+
+    references = []
+    for _ in range(20):
+        references.append(DataBase.GetDataBase())
+        assert DataBase.Reload()
+    assert all(db.GetNumValue("retired") == 1 for db in references)
+    assert len({db.GetVersion() for db in references}) == 20
+
+
+def test_binary(tmp_path):
+    """WriteBinary and ReadBinary preserve the content of the database"""
+    db = read(CONTENT, "source", DataBase.kTokenizer)
+    db.WriteBinary(str(tmp_path / "database.bin"))
+    db.ReadBinary(str(tmp_path / "database.bin"), cppyy.nullptr, "binary")
+    for key in ("pi", "model", "e", "q_e", "signed", "truncated"):
+        assert db.GetNumValue("binary.source." + key) == db.GetNumValue("source." + key)
+        assert db.GetStrValue("binary.source." + key) == db.GetStrValue("source." + key)
+    assert not db.HasNumValue("binary.source.alone")
+
+    filename = tmp_path / "cached.txt"
+    filename.write_text("=cached= a b\n 1 x\n 2 y\n\ncached 3 three\n")
+    db.SetCache(DataBase.kUpdateCache)
+    db.ReadFile(str(filename), cppyy.nullptr, "cached")
+    db.SetCache(DataBase.kNoCache)
+    assert (tmp_path / "cached.txt.bin").exists()
+    assert db.GetTable("cached").GetNbRows() == 2
+    assert db.GetStrValue("cached.cached") == "three"
+
+
+def patch_image(image, offset, fmt, value):
+    """Patch a binary image of a database, then update its checksum"""
+    image = bytearray(image)
+    struct.pack_into(fmt, image, offset, value)
+    mask = (1 << 64) - 1
+    total = 0xCBF29CE484222325
+    records = image[40:]
+    size = len(records) // 8 * 8
+    for (word,) in struct.iter_unpack("<Q", records[:size]):
+        total ^= word
+        total = (((total << 29) | (total >> 35)) & mask) * 0x100000001B3 & mask
+    for byte in records[size:]:
+        total = (total ^ byte) * 0x100000001B3 & mask
+    struct.pack_into("<Q", image, 32, total)
+    return bytes(image)
+
+
+def test_binary_corrupted(tmp_path):
+    """ReadBinary rejects counts and types that the image can not hold, even with a
+    valid checksum"""
+    db = DataBase()
+    db.ReadFile(std.istringstream("=t= a\n x\n\n"))
+    db.WriteBinary(str(tmp_path / "good.bin"))
+    image = (tmp_path / "good.bin").read_bytes()
+    # header of 40 bytes, then the table: kind, "t", NbCol, NbRow, "a", "x", type
+    patches = {
+        "records": (16, "<Q", 1 << 40),
+        "columns": (46, "<I", 1 << 31),
+        "rows": (50, "<I", 1 << 31),
+        "type": (64, "<B", 7),
+    }
+    for name, (offset, fmt, value) in patches.items():
+        filename = tmp_path / (name + ".bin")
+        filename.write_bytes(patch_image(image, offset, fmt, value))
+        with pytest.raises(PyTools.tools.DataBaseError) as exc_info:
+            DataBase().ReadBinary(str(filename))
+        assert "Corrupted image" in str(exc_info.value)
+
+
+def test_table_types():
+    """Unitary test of the typed columns of tools::DataTable"""
+    db = DataBase.GetInputDataBase()
+    db.ReadFile(std.istringstream("=typed= id x name\n 1 0.5 a\n 2 1e3 b\n\n"))
+    table = db.GetTable("typed")
+    DataTable = PyTools.tools.DataTable
+    assert table.GetColumnType("id") == DataTable.kInt
+    assert table.GetColumnType("x") == DataTable.kDouble
+    assert table.GetColumnType("name") == DataTable.kString
+    assert list(table.GetIntColumn("id")) == [1, 2]
+    assert list(table.GetNumColumn("id")) == [1.0, 2.0]
+    assert list(table.GetNumColumn("x")) == [0.5, 1000.0]
+    assert table("x", 1) == 1000.0
+    assert list(table.GetColumn("x")) == ["0.5", "1e3"]
+
+
+def test_table_rows():
+    """Unitary test of tools::DataTable::GetRows and tools::DataTable::Rows"""
+    cppyy.cppdef(
+        """
+        namespace test_rows {
+        struct Pmt {
+            std::int64_t id;
+            double x;
+            std::string name;
+            unsigned char small;
+        };
+        using tools::DataTable;
+        std::vector<Pmt> GetPmts(const DataTable& table) {
+            return table.GetRows(
+                DataTable::Bind("id", &Pmt::id),
+                DataTable::Bind("x", &Pmt::x),
+                DataTable::Bind("name", &Pmt::name));
+        }
+        std::vector<Pmt> GetSmall(const DataTable& table) {
+            return table.GetRows(DataTable::Bind("id", &Pmt::small));
+        }
+        std::string JoinRows(const DataTable& table) {
+            std::string joined;
+            for (auto [id, x, name] : table.Rows<std::int64_t, double, std::string>(
+                     "id", "x", "name")) {
+                joined += std::to_string(id) + ":" + std::to_string(x);
+                joined += ":" + name + ";";
+            }
+            return joined;
+        }
+        }
+    """
+    )
+    test_rows = cppyy.gbl.test_rows
+    db = DataBase()
+    db.ReadFile(std.istringstream("=rows= id x name\n 1 0.5 a\n 300 1e3 b\n\n"))
+    table = db.GetTable("rows")
+
+    pmts = test_rows.GetPmts(table)
+    assert [(pmt.id, pmt.x, str(pmt.name)) for pmt in pmts] == [
+        (1, 0.5, "a"),
+        (300, 1000.0, "b"),
+    ]
+    assert str(test_rows.JoinRows(table)) == "1:0.500000:a;300:1000.000000:b;"
+    with pytest.raises(PyTools.tools.DataBaseError) as exc_info:
+        test_rows.GetSmall(table)
+    assert "Value out of range in column id on row 1" in str(exc_info.value)
+
+    rows = table.Rows["std::int64_t", "double", "std::string"]("id", "x", "name")
+    assert rows.size() == 2
+    assert std.get[0](rows[1]) == 300
+    assert std.get[1](rows[1]) == 1000.0
+    with pytest.raises(PyTools.tools.DataBaseError) as exc_info:
+        table.Rows["std::int64_t"]("x")
+    assert "Not an integer column: x" in str(exc_info.value)
+
+
+def test_table_index():
+    """Unitary test of the indexes of tools::DataTable"""
+    db = DataBase.GetInputDataBase()
+    db.ReadFile(std.istringstream("=indexed= id x name\n 5 0.5 a\n 7 2 b\n 9 1 a\n\n"))
+    table = db.GetTable("indexed")
+    table.BuildIndex("id", PyTools.tools.DataTable.kHash)
+    assert table.FindRow("id", 7) == 1
+    assert table.FindRow("id", 6) == -1
+    assert table.FindRow("name", "a") == 0
+    assert list(table.RowsInRange("x", 0.5, 1.5)) == [0, 2]
+
+
+def test_stream_table(tmp_path):
+    """StreamTable yields the rows of a table as read by ReadFile"""
+    filename = tmp_path / "stream.txt"
+    filename.write_text("first 1\n=streamed= id x name\n 5 0.5 a\n 7 2 b\n\nlast 2\n")
+    db = DataBase.GetInputDataBase()
+    rows = []
+
+    def callback(row):
+        rows.append((row.GetRow(), row.GetInt(0), row.GetNum(1), str(row[2])))
+
+    db.StreamTable(str(filename), "streamed", callback)
+    assert rows == [(0, 5, 0.5, "a"), (1, 7, 2.0, "b")]
+
+
+def test_instances():
+    """Independent instances of tools::DataBase and their clones"""
+    nominal = DataBase()
+    nominal.ReadFile(std.istringstream("shift 1\n=shared= a\n 1\n\n"))
+    variation = nominal.Clone()
+    handle = variation.GetHandle("shift")
+    variation.ReadFile(std.istringstream("shift 2\n"), "", DataBase.kOverride)
+    assert nominal.GetNumValue("shift") == 1
+    assert variation.GetNumValue("shift") == 2
+    assert handle.GetNumValue() == 2
+    assert variation.GetTable("shared").GetNbRows() == 1
+    assert not DataBase.GetInputDataBase().HasNumValue("shift")
+
+
+def test_prefix():
+    """Unitary test of tools::DataBase::GetHandlesWithPrefix and GetNumValues"""
+    db = DataBase()
+    db.ReadFile(std.istringstream("gain0 1\ngain1 2\nname text\n"), "pmt")
+    db.ReadFile(std.istringstream("other 3\n"), "pmtx")
+    keys = [str(handle.GetKey()) for handle in db.GetHandlesWithPrefix("pmt")]
+    assert keys == ["pmt.gain0", "pmt.gain1", "pmt.name"]
+
+    values = array.array("d", [0.0, 0.0])
+    db.GetNumValues("pmt", std.vector[std.string_view](["gain1", "gain0"]), values)
+    assert list(values) == [2.0, 1.0]
+
+    # a moved-from database is empty, but can still be queried
+    moved = DataBase(std.move(db))
+    assert len(moved.GetHandlesWithPrefix("pmt")) == 3
+    assert len(db.GetHandlesWithPrefix("pmt")) == 0
+    db.SetNumValue("pmt.gain2", 4)
+    assert [handle.GetNumValue() for handle in db.GetHandlesWithPrefix("pmt")] == [4]
+
+
+def test_diagnostics(tmp_path):
+    """The warnings of a reading are counted in tools::DataBase::GetDiagnostics"""
+    db = DataBase()
+    db.SetVerbosity(DataBase.kQuiet)
+    db.ReadFile(std.istringstream("a 1\nb 2\n"))
+    db.ReadFile(std.istringstream("a 3\nb 4\n bad line\n"), "", DataBase.kOverride)
+    diagnostics = db.GetDiagnostics()
+    assert diagnostics.Count[DataBase.kOverridden] == 2
+    assert diagnostics.Count[DataBase.kBadLine] == 1
+    assert [str(key) for key in diagnostics.Examples[DataBase.kOverridden]] == ["a", "b"]
+    assert db.GetNumValue("a") == 3
+    assert diagnostics.Count[DataBase.kCache] == 0
+
+    # a corrupt binary image is ignored, with a warning instead of a message
+    filename = tmp_path / "cached.txt"
+    filename.write_text("c 5\n")
+    image = tmp_path / "cached.txt.bin"
+    image.write_bytes(b"not an image")
+    mtime = filename.stat().st_mtime_ns + 1_000_000_000
+    os.utime(image, ns=(mtime, mtime))
+    db.SetCache(DataBase.kUseCache)
+    db.ReadFile(str(filename), cppyy.nullptr, "")
+    diagnostics = db.GetDiagnostics()
+    assert diagnostics.Count[DataBase.kCache] == 1
+    assert "Not a binary image" in str(diagnostics.Examples[DataBase.kCache][0])
+    assert db.GetNumValue("c") == 5
+
+
+def test_write_text(tmp_path):
+    """WriteText writes the numbers with 15 significant digits and the tables"""
+    db = DataBase()
+    content = "pi 3.14159265358979312\nq 1e-19 C\n=t= a b\n 1 x\n\n"
+    db.ReadFile(std.istringstream(content))
+    db.WriteText(str(tmp_path / "written.txt"))
+    text = (tmp_path / "written.txt").read_text()
+    assert text.startswith("pi 3.14159265358979\nq 1e-19 : C\n")
+    assert text.endswith("\n\nt\n\ta\tb\n\t1\tx\n")
@@ -0,0 +1,191 @@
+"""Unitary tests of Rand.hh"""
+
+import array
+import math
+
+import PyTools
+
+Rand = PyTools.tools.Rand
+RandomStream = PyTools.tools.RandomStream
+
+
+def test_seed():
+    """The same seed yields the same numbers"""
+    Rand.SetSeed(42)
+    first = [Rand.Uniform(), Rand.Gauss(), Rand.Poisson(3.0)]
+    Rand.SetSeed(42)
+    assert [Rand.Uniform(), Rand.Gauss(), Rand.Poisson(3.0)] == first
+    assert Rand.GetSeed() == 42
+
+
+def test_streams():
+    """The stream of a thread is the stream of its index, independent of the others"""
+    Rand.SetSeed(42)
+    Rand.SetStreamIndex(3)
+    drawn = [Rand.Uniform() for _ in range(10)]
+    stream = RandomStream(42, 3)
+    assert [stream.Uniform() for _ in range(10)] == drawn
+    other = RandomStream(42, 4)
+    assert [other.Uniform() for _ in range(10)] != drawn
+
+
+def test_philox():
+    """Philox matches the known answers of Random123 and is addressable by position"""
+    Philox = PyTools.tools.Philox
+    known = Philox.Encrypt(
+        Philox.Counter([0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344]),
+        Philox.Key([0xA4093822, 0x299F31D0]),
+    )
+    assert list(known) == [0xD16CFE09, 0x94FDCCEB, 0x5001E420, 0x24126EA1]
+
+    engine = Philox(7, 3)
+    drawn = [engine() for _ in range(5)]
+    engine.SetPosition(3)
+    assert engine() == drawn[3]
+
+
+def test_philox_event():
+    """An event is regenerated alone from its stream index"""
+    PhiloxRand = PyTools.tools.PhiloxRand
+    PhiloxRand.SetSeed(1)
+    PhiloxRand.SetStreamIndex(12)
+    event = [PhiloxRand.Gauss() for _ in range(5)]
+    stream = PyTools.tools.PhiloxStream(1, 12)
+    assert [stream.Gauss() for _ in range(5)] == event
+
+
+def test_philox_event_distributions():
+    """An event is regenerated alone whatever the distributions drawn before"""
+    PhiloxRand = PyTools.tools.PhiloxRand
+    PhiloxRand.SetSeed(1)
+
+    def event():
+        return (
+            [PhiloxRand.Gamma(2.0, 3.0) for _ in range(3)]
+            + [PhiloxRand.Chi2(4.0) for _ in range(3)]
+            + [PhiloxRand.Poisson(3.5) for _ in range(3)]
+            + [PhiloxRand.Gauss() for _ in range(3)]
+        )
+
+    PhiloxRand.SetStreamIndex(12)
+    first = event()
+    for index in (12, 13, 12):
+        PhiloxRand.SetStreamIndex(index)
+        event()  # leave the distributions in the middle of an event
+    PhiloxRand.SetStreamIndex(12)
+    assert event() == first
+
+    stream = PyTools.tools.PhiloxStream(1, 12)
+    fresh = (
+        [stream.Gamma(2.0, 3.0) for _ in range(3)]
+        + [stream.Chi2(4.0) for _ in range(3)]
+        + [stream.Poisson(3.5) for _ in range(3)]
+        + [stream.Gauss() for _ in range(3)]
+    )
+    assert fresh == first
+
+
+def test_fill():
+    """Fill yields the successive draws, or the same distribution in fast mode"""
+    Rand.SetSeed(5)
+    drawn = [Rand.Gauss(2.0, 3.0) for _ in range(100)]
+    poisson = [Rand.Poisson(3.5) for _ in range(100)]
+    Rand.SetSeed(5)
+    values = array.array("d", [0.0] * 100)
+    Rand.FillGauss(values, len(values), 2.0, 3.0)
+    assert list(values) == drawn
+    counts = array.array("i", [0] * 100)
+    Rand.FillPoisson(counts, len(counts), 3.5)
+    assert list(counts) == poisson
+
+    values = array.array("d", [0.0] * 100_000)
+    Rand.FillUniform(values, len(values), Rand.kFast)
+    assert all(0 <= value < 1 for value in values)
+    assert abs(sum(values) / len(values) - 0.5) < 0.01
+
+
+def test_philox_instructions():
+    """The SIMD versions of Philox yield the numbers of the scalar one"""
+    Philox = PyTools.tools.Philox
+    supported = Philox.GetInstructions()
+    generated = []
+    for instructions in (Philox.kScalar, Philox.kAVX2, Philox.kAVX512):
+        Philox.SetInstructions(instructions)
+        engine = Philox(99, 5)
+        engine.SetPosition(3)
+        values = array.array("d", [0.0] * 101)
+        engine.GenerateUniform(values, len(values))
+        generated.append(list(values))
+    Philox.SetInstructions(supported)
+    assert generated[0] == generated[1] == generated[2]
+
+    engine = Philox(99, 5)
+    engine.SetPosition(3)
+    assert generated[0][0] == (engine() >> 11) * 2.0**-53
+
+
+def kolmogorov_smirnov(sample, cdf):
+    """Kolmogorov-Smirnov statistic of the sample, times the square root of its size"""
+    sample = sorted(sample)
+    n = len(sample)
+    distance = max(
+        max(cdf(x) - i / n, (i + 1) / n - cdf(x)) for i, x in enumerate(sample)
+    )
+    return distance * math.sqrt(n)
+
+
+def two_samples_distance(first, second):
+    """Two samples Kolmogorov-Smirnov statistic, scaled as the one sample one"""
+    points = sorted([(x, 0) for x in first] + [(x, 1) for x in second])
+    n, m = len(first), len(second)
+    counts = [0, 0]
+    distance = 0
+    for _, which in points:
+        counts[which] += 1
+        distance = max(distance, abs(counts[0] / n - counts[1] / m))
+    return distance * math.sqrt(n * m / (n + m))
+
+
+def draw(fill, size, algorithm, *parameters):
+    """Draw a sample with the given algorithm of Gauss and Exp"""
+    Rand.SetSeed(7)
+    Rand.SetAlgorithm(algorithm)
+    values = array.array("d", [0.0] * size)
+    fill(values, size, *parameters)
+    Rand.SetAlgorithm(Rand.kStandard)
+    return list(values)
+
+
+def test_ziggurat_gauss():
+    """The Ziggurat yields the normal distribution of the standard algorithm"""
+    # 1.95 is the 0.1% critical value of the Kolmogorov-Smirnov statistic
+    size = 100_000
+    ziggurat = draw(Rand.FillGauss, size, Rand.kZiggurat, 1.0, 2.0)
+    standard = draw(Rand.FillGauss, size, Rand.kStandard, 1.0, 2.0)
+    assert ziggurat != standard
+    normal = lambda x: 0.5 * math.erfc((1.0 - x) / (2.0 * math.sqrt(2.0)))
+    assert kolmogorov_smirnov(ziggurat, normal) < 1.95
+    assert two_samples_distance(ziggurat, standard) < 1.95
+    mean = sum(ziggurat) / size
+    variance = sum((x - mean) ** 2 for x in ziggurat) / size
+    assert abs(mean - 1.0) < 4 * 2.0 / math.sqrt(size)
+    assert abs(variance - 4.0) < 4 * 4.0 * math.sqrt(2.0 / size)
+
+
+def test_ziggurat_exp():
+    """The Ziggurat yields the exponential distribution of the standard algorithm"""
+    size = 100_000
+    ziggurat = draw(Rand.FillExp, size, Rand.kZiggurat, 2.0)
+    standard = draw(Rand.FillExp, size, Rand.kStandard, 2.0)
+    assert ziggurat != standard
+    exponential = lambda x: 1.0 - math.exp(-2.0 * x)
+    assert kolmogorov_smirnov(ziggurat, exponential) < 1.95
+    assert two_samples_distance(ziggurat, standard) < 1.95
+    assert min(ziggurat) >= 0
+    assert abs(sum(ziggurat) / size - 0.5) < 4 * 0.5 / math.sqrt(size)
+
+    # the tail beyond the base layer of the Ziggurat, r = 7.697 for a unit rate
+    sample = draw(Rand.FillExp, 2_000_000, Rand.kZiggurat, 1.0)
+    beyond = sum(x > 7.69711747013104972 for x in sample)
+    expected = len(sample) * math.exp(-7.69711747013104972)
+    assert abs(beyond - expected) < 4 * math.sqrt(expected)